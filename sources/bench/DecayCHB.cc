@@ -0,0 +1,67 @@
+/**********************************************************************************[DecayCHB.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Compares the anti-exploration decay of LRB by 'pow(0.95, age)' with the lookup of
+// 'AntiExplorationDecay' in 'core/SolverTypes.h', over 20M random ages in 1..3000 (the ages most
+// variables have when 'decayActivityCHB()' sees them), and checks that both agree.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+
+#include "mtl/Vec.h"
+#include "utils/System.h"
+#include "core/SolverTypes.h"
+
+using namespace Minisat;
+
+static const int Ages    = 20000000;
+static const int MaxAge  = 3000;
+
+static uint64_t rng = 88172645463325252ULL;
+static uint32_t rand32() { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return (uint32_t)rng; }
+
+int main()
+{
+    vec<uint32_t> ages;
+    for (int i = 0; i < Ages; i++) ages.push(1 + rand32() % MaxAge);
+    AntiExplorationDecay decay;
+
+    // The sums keep the loops from being optimized away:
+    double sum_pow = 0, start = cpuTime();
+    for (int i = 0; i < Ages; i++) sum_pow += pow(0.95, ages[i]);
+    double ns_pow = (cpuTime() - start) * 1e9 / Ages;
+
+    double sum_table = 0;
+    start = cpuTime();
+    for (int i = 0; i < Ages; i++) sum_table += decay(ages[i]);
+    double ns_table = (cpuTime() - start) * 1e9 / Ages;
+
+    // The lookup multiplies two rounded powers, so it may differ from 'pow()' in the last bits (and
+    // more once the power is denormal, from an age of about 13800 on, where neither is exact):
+    double worst = 0;
+    for (uint32_t age = 0; age < 16384; age++){
+        double p = pow(0.95, age);
+        if (p < DBL_MIN) break;
+        double err = fabs(decay(age) - p) / p;
+        if (err > worst) worst = err; }
+
+    printf("ns per decay:  pow %.1f  table %.1f   (sums %.6g / %.6g)\n", ns_pow, ns_table, sum_pow, sum_table);
+    printf("largest relative error (normal powers): %.3g\n", worst);
+    return worst < 1e-12 ? 0 : 1;
+}
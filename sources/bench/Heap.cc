@@ -0,0 +1,104 @@
+/**************************************************************************************[Heap.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Compares the arities of the decision heap in 'mtl/Heap.h', ordered by activity as in the solver.
+// For each heap size 'n' (given on the command line, or 1M and 4M), it times:
+//   decrease  -- 4M bumps of a random variable (its activity grows),
+//   increase  -- 4M decays of a random variable (its activity shrinks),
+//   removeMin -- 2M removals of the top, each put back with a new activity, as after backtracking.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "mtl/Vec.h"
+#include "mtl/Heap.h"
+#include "utils/System.h"
+
+using namespace Minisat;
+
+static const int Changes  = 4000000;
+static const int Removals = 2000000;
+
+static uint64_t rng = 88172645463325252ULL;
+static uint32_t rand32() { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return (uint32_t)rng; }
+static double   rand01() { return (((uint64_t)rand32() << 21) ^ rand32()) / 9007199254740992.0; }   // (53 bits, so no ties)
+
+struct ActivityLt {
+    const vec<double>& activity;
+    bool operator () (int x, int y) const { return activity[x] > activity[y]; }
+    ActivityLt(const vec<double>& act) : activity(act) { }
+};
+
+// Milliseconds for each of the three operations, and a checksum of the order of the removed tops:
+static void run(int n, int arity, double ms[3], uint64_t& check)
+{
+    vec<double> activity(n);
+    vec<int>    vars;
+    for (int v = 0; v < n; v++){
+        activity[v] = rand01();
+        vars.push(v); }
+    Heap<ActivityLt> heap(ActivityLt(activity), arity);
+    heap.build(vars);
+
+    double start = cpuTime();
+    for (int i = 0; i < Changes; i++){
+        int v = rand32() % n;
+        activity[v] += rand01();
+        heap.decrease(v); }
+    ms[0] = (cpuTime() - start) * 1000;
+
+    start = cpuTime();
+    for (int i = 0; i < Changes; i++){
+        int v = rand32() % n;
+        activity[v] *= rand01();
+        heap.increase(v); }
+    ms[1] = (cpuTime() - start) * 1000;
+
+    check = 0;
+    start = cpuTime();
+    for (int i = 0; i < Removals; i++){
+        int v = heap.removeMin();
+        check = check * 31 + v;
+        activity[v] = rand01();
+        heap.insert(v); }
+    ms[2] = (cpuTime() - start) * 1000;
+}
+
+int main(int argc, char** argv)
+{
+    vec<int> sizes;
+    for (int i = 1; i < argc; i++) sizes.push(atoi(argv[i]));
+    if (sizes.size() == 0){ sizes.push(1 << 20); sizes.push(4 << 20); }
+
+    printf("ms for %d decrease / %d increase / %d removeMin+insert:\n", Changes, Changes, Removals);
+    for (int s = 0; s < sizes.size(); s++){
+        uint64_t ref = 0;
+        for (int arity = 2; arity <= 16; arity *= 2){
+            // The same random activities and operations for every arity, so they must remove the
+            // same tops:
+            double   ms[3];
+            uint64_t check;
+            rng = 88172645463325252ULL + s;
+            run(sizes[s], arity, ms, check);
+            if (arity == 2) ref = check;
+            else if (check != ref){
+                printf("d=%d removes other tops than d=2 at n=%d\n", arity, sizes[s]);
+                return 1; }
+            printf("  n=%-9d d=%-2d  %7.0f / %7.0f / %7.0f\n", sizes[s], arity, ms[0], ms[1], ms[2]); } }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*******************************************************************************[WatchSearch.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Compares the kernels of the replacement watch search in 'core/WatchSearch.h'. Every clause has
+// all literals false except one, which sits at a uniformly random position of 'c[2..size)' (or is
+// missing, one time in 'size'), as when 'propagate()' looks for a new watch.
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "mtl/Vec.h"
+#include "utils/System.h"
+#include "core/WatchSearch.h"
+
+using namespace Minisat;
+
+static const int Vars    = 1 << 16;
+static const int Clauses = 20000;
+static const int Rounds  = 50;
+static const int Repeats = 5;       // The fastest of these many timings is reported.
+
+static uint64_t rng = 88172645463325252ULL;
+static uint32_t rand32() { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return (uint32_t)rng; }
+
+// Nanoseconds per scan of 'fn' over all clauses, and the sum of the positions it found:
+static double run(FindWatchFn fn, const vec<Lit>& lits, int size, const lbool* lit_assigns, uint64_t& sum)
+{
+    double best = 0;
+    for (int t = 0; t < Repeats; t++){
+        sum = 0;
+        double start = cpuTime();
+        for (int r = 0; r < Rounds; r++)
+            for (int i = 0; i < Clauses; i++)
+                sum += fn(&lits[i * size], 2, size, lit_assigns);
+        double ns = (cpuTime() - start) * 1e9 / ((double)Rounds * Clauses);
+        if (t == 0 || ns < best) best = ns; }
+    return best;
+}
+
+int main()
+{
+    // Every variable is assigned; 'lit_assigns' keeps the 3 bytes of slack the gathers need:
+    vec<lbool> lit_assigns;
+    lit_assigns.capacity(2 * Vars + 3);
+    for (int v = 0; v < Vars; v++){
+        bool b = rand32() & 1;
+        lit_assigns.push(lbool(b));
+        lit_assigns.push(lbool(!b)); }
+    for (int i = 0; i < 3; i++) lit_assigns.push(l_Undef);
+    lit_assigns.shrink(3);
+
+    const char* names[] = { "scalar", "avx2", "avx512" };
+    FindWatchFn kernels[] = { findWatchScalar, NULL, NULL };
+#ifdef WIDE_WATCH_SEARCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))    kernels[1] = findWatchAVX2;
+    if (__builtin_cpu_supports("avx512f")) kernels[2] = findWatchAVX512;
+#endif
+
+    printf("ns per scan of %d clauses:\n", Clauses);
+    printf("  size   scalar     avx2   avx512\n");
+    const int sizes[] = { 16, 24, 32, 64, 128 };
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++){
+        int size = sizes[s];
+        vec<Lit> lits;
+        for (int i = 0; i < Clauses; i++){
+            int keep = 2 + rand32() % (size - 1);   // 'size' means none.
+            for (int k = 0; k < size; k++){
+                Var v = rand32() % Vars;
+                Lit p = mkLit(v, lit_assigns[toInt(mkLit(v))] == l_True);
+                lits.push(k == keep ? ~p : p); } }
+
+        printf("%6d", size);
+        uint64_t ref = 0;
+        for (int k = 0; k < 3; k++){
+            if (kernels[k] == NULL){ printf("        -"); continue; }
+            uint64_t sum;
+            double   ns = run(kernels[k], lits, size, (const lbool*)lit_assigns, sum);
+            if (k == 0) ref = sum;
+            else if (sum != ref){
+                printf("\n%s disagrees with scalar at size %d\n", names[k], size);
+                return 1; }
+            printf(" %8.1f", ns); }
+        printf("\n"); }
+    return 0;
+}
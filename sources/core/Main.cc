@@ -97,6 +97,7 @@ int main(int argc, char** argv)
         IntOption     opt_redis_buffer      ("REDIS", "redis-buffer",    "The maximum packet length in Redis",  5000, IntRange(100, 10000));
         IntOption     opt_redis_port        ("REDIS", "redis-port",      "Redis port",  6379, IntRange(100, 10000));
         StringOption  opt_redis_host        ("REDIS", "redis-host",      "Redis host",  "127.0.0.1");
+        IntOption     opt_redis_shared      ("REDIS", "redis-shared",    "Number of clause fingerprints remembered to skip clauses already saved or loaded",  1 << 20, IntRange(1, INT32_MAX/4));
 
         
         parseOptions(argc, argv, true);
@@ -110,6 +111,7 @@ int main(int argc, char** argv)
         redis.redis_last_from_minisat_id = 0;
         redis.redis_buffer = opt_redis_buffer;
         redis.max_clause_len = opt_max_clause_len;
+        redis.shared.init(opt_redis_shared);
         redis.units.clear();
         redis.learnts.clear();
         S.redis = &redis;
@@ -7,7 +7,7 @@
 
 namespace Minisat {
 
-Redis::Redis(Solver& solver) : solverRef(solver) {
+Redis::Redis(Solver& solver) : solverRef(solver), skipped_saves(0), skipped_loads(0) {
 
 }
 
@@ -46,7 +46,7 @@ char* Redis::to_str(Lit lit) {
     return charFormula;
 }
 
-bool Redis::from_str(char* formula, vec<Lit>& learnt_clause) {
+bool Redis::from_str(char* formula, vec<Lit>& learnt_clause, uint64_t& fp) {
     if (solverRef.verbosity > 1) fprintf(stderr, "from_str(formula = %p)\n", formula);
     char* token = strtok(formula, " ");
 
@@ -62,6 +62,7 @@ bool Redis::from_str(char* formula, vec<Lit>& learnt_clause) {
         }
         int var = abs(elit)-1;
         learnt_clause.push( (elit > 0) ? mkLit(var) : ~mkLit(var));
+        fp += litHash(learnt_clause.last());
         token = strtok(NULL, " ");
     }
     return true;
@@ -166,6 +167,19 @@ bool Redis::save_learnt_clauses(redisContext* context) {
                 continue;
             }
 
+            // Clauses are attached again after simplification, and may have come from redis in the
+            // first place:
+            uint64_t fp = 0;
+            if (c.learnt())
+                fp = c.fingerprint();
+            else
+                for (int i = 0; i < c.size(); i++) fp += litHash(c[i]);
+            if (shared[fp != 0 ? fp : 1]++ > 0) {
+                skipped_saves++;
+                buf--;
+                continue;
+            }
+
             redisAppendCommand(context, "SET from_minisat:%d %s", redis_last_from_minisat_id + __offset, to_str(c));
             if (redis_last_from_minisat_id > INT_MAX - __offset) {
                 fprintf(stderr, "Int overflow");
@@ -184,7 +198,7 @@ bool Redis::save_learnt_clauses(redisContext* context) {
     }
     redis_last_from_minisat_id += __offset;
     if (solverRef.verbosity > 1)
-        fprintf(stderr, "new saved: %d\n", __offset);
+        fprintf(stderr, "new saved: %d, skipped: %llu\n", __offset, (unsigned long long)skipped_saves);
     if (learnts.size() != curr) {
         // TODO may be more checks
         fprintf(stderr, "Not all learnts be store");
@@ -235,7 +249,28 @@ bool Redis::load_clause(redisReply* element, vec<Lit>& learnt_clause) {
         fprintf(stderr, "Error: element == NULL || element->type != REDIS_REPLY_STRING || element->str == NULL\n");
         exit(3);
     }
-    from_str(element->str, learnt_clause);
+    uint64_t fp = 0;
+    from_str(element->str, learnt_clause, fp);
+
+    if (solverRef.substituted > 0) {
+        // Other solvers still use the variables substituted here:
+        if (!solverRef.substitute(learnt_clause))
+            return true;
+        fp = 0;
+        for (int i = 0; i < learnt_clause.size(); i++)
+            fp += litHash(learnt_clause[i]);
+    }
+
+    // The variables eliminated here occur in no clause any more, and must not come back:
+    for (int i = 0; i < learnt_clause.size(); i++)
+        if (solverRef.isEliminated(var(learnt_clause[i])))
+            return true;
+
+    if (learnt_clause.size() > 1 && shared[fp != 0 ? fp : 1]++ > 0) {
+        // Already saved or loaded by this solver:
+        skipped_loads++;
+        return true;
+    }
 
     int lbd = learnt_clause.size();
 
@@ -269,13 +304,11 @@ bool Redis::load_clause(redisReply* element, vec<Lit>& learnt_clause) {
          //флаг True, так как я исползую extra поле touched, которе нужно при reduceDB_Tier2
 
         solverRef.ca[cr].set_lbd(lbd);
+        solverRef.ca[cr].fingerprint(fp);
         //duplicate learnts
         int id = 0;
         if (lbd <= solverRef.max_lbd_dup){
-            std::vector<uint32_t> tmp;
-            for (int i = 0; i < learnt_clause.size(); i++)
-                tmp.push_back(learnt_clause[i].x);
-            id = solverRef.is_duplicate(tmp);
+            id = solverRef.is_duplicate(fp);
             if (id == solverRef.min_number_of_learnts_copies +1){
                 //solverRef.duplicates_added_conflicts++; // эта штука не нужна, так как нет конфликта
             }
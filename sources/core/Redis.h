@@ -24,10 +24,13 @@ public:
     unsigned int max_clause_len;
     vec<Lit>           units;          // List of unit in DL=0
     vec<CRef>          learnts;        // List of learnts
+    DupTable           shared;         // Fingerprints of the clauses already saved or loaded
+    uint64_t           skipped_saves;
+    uint64_t           skipped_loads;
 
     char* to_str(const Clause&);
     char* to_str(Lit);
-    bool from_str(char*, vec<Lit>&);
+    bool from_str(char*, vec<Lit>&, uint64_t& fp);
 
     redisContext* get_context();
     void redis_free(redisContext*);
@@ -35,7 +35,9 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include <unistd.h>
 
 #include "mtl/Sort.h"
+#include "utils/System.h"
 #include "core/Solver.h"
+#include "core/WatchSearch.h"
 
 using namespace Minisat;
 
@@ -69,15 +71,38 @@ static DoubleOption  opt_restart_inc       (_cat, "rinc",        "Restart interv
 static DoubleOption  opt_garbage_frac      (_cat, "gc-frac",     "The fraction of wasted memory allowed before a garbage collection is triggered",  0.20, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption     opt_chrono            (_cat, "chrono",  "Controls if to perform chrono backtrack", 100, IntRange(-1, INT32_MAX));
 static IntOption     opt_conf_to_chrono    (_cat, "confl-to-chrono",  "Controls number of conflicts to perform chrono backtrack", 4000, IntRange(-1, INT32_MAX));
+static IntOption     opt_simd_watch_min    (_cat, "simd-watch-min", "Minimal clause size for the vectorized replacement watch search (0=off)", 24, IntRange(0, INT32_MAX));
+static IntOption     opt_arena_reserve     (_cat, "arena-reserve", "Address space (in MiB) to reserve for the clause arena so it grows in place (0=off)", 0, IntRange(0, INT32_MAX));
+static BoolOption    opt_arena_huge        (_cat, "arena-huge",  "Back a reserved clause arena with huge pages (committed up front if from the huge page pool)", false);
+static BoolOption    opt_watch_pool        (_cat, "watch-pool",  "Allocate watch lists from a shared pool", true);
+static DoubleOption  opt_vivify_effort     (_cat, "vivify-effort", "Propagations spent vivifying learnt clauses per propagation of search", 0.1, DoubleRange(0, true, HUGE_VAL, true));
+static DoubleOption  opt_vivify_local      (_cat, "vivify-local", "Propagations spent vivifying local learnt clauses per propagation of search", 0, DoubleRange(0, true, HUGE_VAL, true));
+static BoolOption    opt_vivify_thread     (_cat, "vivify-thread", "Vivify learnt clauses on a helper thread instead of between restarts", false);
+static BoolOption    opt_subst             (_cat, "subst",       "Substitute equivalent literals found in the binary implication graph", true);
+static DoubleOption  opt_transred_effort   (_cat, "transred-effort", "Binary implication graph edges visited by transitive reduction per propagation of search", 0.05, DoubleRange(0, true, HUGE_VAL, true));
+static DoubleOption  opt_probe_effort      (_cat, "probe-effort", "Propagations spent probing failed literals per propagation of search", 0.02, DoubleRange(0, true, HUGE_VAL, true));
+static DoubleOption  opt_subsume_effort    (_cat, "subsume-effort", "Occurrences scanned by learnt clause subsumption per propagation of search", 0.3, DoubleRange(0, true, HUGE_VAL, true));
+static BoolOption    opt_xor               (_cat, "xor",         "Detect XOR constraints and propagate them by Gaussian elimination", true);
+static IntOption     opt_xor_max_size      (_cat, "xor-max-size", "Maximal size of the XOR constraints detected", 5, IntRange(3, 6));
+static IntOption     opt_xor_max_vars      (_cat, "xor-max-vars", "Maximal number of variables of one Gaussian elimination matrix", 4096, IntRange(2, INT32_MAX));
+static BoolOption    opt_gc_locality       (_cat, "gc-locality", "Lay clauses out in propagation order when collecting garbage", true);
+static IntOption     opt_vmtf              (_cat, "vmtf",        "Order decisions by VMTF instead of VSIDS (0=never, 1=every other VSIDS phase, 2=always)", 0, IntRange(0, 2));
+static IntOption     opt_chb_arity         (_cat, "chb-arity",   "Number of children per node in the CHB decision heap (a power of two)",      4, IntRange(2, 64));
+static IntOption     opt_vsids_arity       (_cat, "vsids-arity", "Number of children per node in the VSIDS decision heap (a power of two)",    4, IntRange(2, 64));
+static IntOption     opt_dist_arity        (_cat, "dist-arity",  "Number of children per node in the distance decision heap (a power of two)", 4, IntRange(2, 64));
 
 static IntOption     opt_max_lbd_dup       ("DUP-LEARNTS", "lbd-limit",  "specifies the maximum lbd of learnts to be screened for duplicates.", 12, IntRange(0, INT32_MAX));
 static IntOption     opt_min_dupl_app      ("DUP-LEARNTS", "min-dup-app",  "specifies the minimum number of learnts to be included into db.", 3, IntRange(2, INT32_MAX));
-static IntOption     opt_dupl_db_init_size ("DUP-LEARNTS", "dupdb-init",  "specifies the initial maximal duplicates DB size.", 500000, IntRange(1, INT32_MAX));
+static IntOption     opt_dupl_db_size      ("DUP-LEARNTS", "dupdb-size",  "specifies the maximal number of learnts kept in the duplicates DB.", 500000, IntRange(1, INT32_MAX/4));
 
 static IntOption     opt_VSIDS_props_limit ("DUP-LEARNTS", "VSIDS-lim",  "specifies the number of propagations after which the solver switches between LRB and VSIDS(in millions).", 30, IntRange(1, INT32_MAX));
 
 //VSIDS_props_limit
 
+// The replacement watch search of 'propagate()' (see 'core/WatchSearch.h'):
+static const FindWatchFn findWatchWide = selectFindWatch();
+
+
 //=================================================================================================
 // Constructor/Destructor:
 
@@ -97,18 +122,22 @@ Solver::Solver() :
   , random_var_freq  (opt_random_var_freq)
   , random_seed      (opt_random_seed)
   , VSIDS            (false)
+  , vmtf_mode        (opt_vmtf)
+  , VMTF             (false)
   , ccmin_mode       (opt_ccmin_mode)
   , phase_saving     (opt_phase_saving)
   , rnd_pol          (false)
   , rnd_init_act     (opt_rnd_init_act)
   , garbage_frac     (opt_garbage_frac)
+  , simd_watch_min   (opt_simd_watch_min)
+  , gc_locality      (opt_gc_locality)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
 
 
   , min_number_of_learnts_copies(opt_min_dupl_app)  
   , max_lbd_dup(opt_max_lbd_dup)
-  , dupl_db_init_size(opt_dupl_db_init_size)
+  , dupl_db_max_size(opt_dupl_db_size)
   , VSIDS_props_limit(opt_VSIDS_props_limit*1000000)
 
   // Parameters (the rest):
@@ -125,6 +154,7 @@ Solver::Solver() :
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0), conflicts_VSIDS(0)
   , dec_vars(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
   , chrono_backtrack(0), non_chrono_backtrack(0)
+  , garbage_collections(0), gc_propagations(0), original_collections(0), gc_time(0)
 
   , ok                 (true)
   , cla_inc            (1)
@@ -134,8 +164,8 @@ Solver::Solver() :
   , qhead              (0)
   , simpDB_assigns     (-1)
   , simpDB_props       (0)
-  , order_heap_CHB     (VarOrderLt(activity_CHB))
-  , order_heap_VSIDS   (VarOrderLt(activity_VSIDS))
+  , order_heap_CHB     (VarOrderLt(activity_CHB), opt_chb_arity)
+  , order_heap_VSIDS   (VarOrderLt(activity_VSIDS), opt_vsids_arity)
   , progress_estimate  (0)
   , remove_satisfied   (true)
 
@@ -158,6 +188,44 @@ Solver::Solver() :
   // simplfiy
   , nbSimplifyAll(0)
   , s_propagations(0)
+  , vivify_effort(opt_vivify_effort)
+  , vivify_local(opt_vivify_local)
+  , vivify_props(0)
+  , vivifier(opt_vivify_thread ? new Vivifier() : NULL)
+  , clause_deletions(0)
+  , vivify_epoch(0)
+  , original_changes(0)
+  , vivify_base_epoch(0)
+  , subst_equiv(opt_subst)
+  , substituted(0)
+  , transred_effort(opt_transred_effort)
+  , probe_effort(opt_probe_effort)
+  , transred_next(0)
+  , probe_next(0)
+  , bin_stamp_cur(0)
+  , probe_pass(0)
+  , bin_ticks(0)
+  , transred_removed(0)
+  , probe_failed(0)
+  , probe_necessary(0)
+  , probe_hbrs(0)
+  , subsume_effort(opt_subsume_effort)
+  , subsume_next(0)
+  , subsume_ticks(0)
+  , subsumed_learnts(0)
+  , strengthened_learnts(0)
+  , subsume_saved(0)
+  , subsume_passes(0)
+  , use_xor(opt_xor)
+  , xor_max_size(opt_xor_max_size)
+  , xor_max_vars(opt_xor_max_vars)
+  , xor_stale(opt_xor)
+  , xor_qhead(0)
+  , xors_found(0)
+  , xor_rows(0)
+  , xor_props(0)
+  , xor_conflicts(0)
+  , xor_reasons(0)
 
   // simplifyAll adjust occasion
   , curSimplify(1)
@@ -167,12 +235,33 @@ Solver::Solver() :
   , my_var_decay       (0.6)
   , DISTANCE           (true)
   , var_iLevel_inc     (1)
-  , order_heap_distance(VarOrderLt(activity_distance))
-{}
+  , order_heap_distance(VarOrderLt(activity_distance), opt_dist_arity)
+  , order_heap_active  (NULL)
+  , vmtf_first         (var_Undef)
+  , vmtf_last          (var_Undef)
+  , vmtf_cursor        (var_Undef)
+  , vmtf_stamp         (0)
+  , vmtf_phases        (0)
+  , redis              (NULL)
+{
+    // The regions of 'ca' start out on the heap and move into a reservation the first time they grow.
+    RegionAllocator<uint32_t>::map_reserve = (size_t)opt_arena_reserve << 20;
+    RegionAllocator<uint32_t>::map_huge    = opt_arena_huge;
+
+    orderHeap();
+    dup_table.init(dupl_db_max_size);
+
+    if (opt_watch_pool){
+        watches_bin.bind(&watch_pool);
+        watches    .bind(&watch_pool); }
+}
 
 
 Solver::~Solver()
 {
+    delete vivifier;
+    for (int i = 0; i < xor_matrices.size(); i++)
+        delete xor_matrices[i];
 }
 
 
@@ -181,19 +270,18 @@ Solver::~Solver()
 CRef Solver::simplePropagate()
 {
     CRef    confl = CRef_Undef;
-    int     num_props = 0;
     watches.cleanAll();
     watches_bin.cleanAll();
     while (qhead < trail.size())
     {
         Lit            p = trail[qhead++];     // 'p' is enqueued fact to propagate.
-        vec<Watcher>&  ws = watches[p];
+        PoolVec<Watcher>&  ws = watches[p];
         Watcher        *i, *j, *end;
-        num_props++;
+        s_propagations++;
 
 
         // First, Propagate binary clauses
-        vec<Watcher>&  wbin = watches_bin[p];
+        PoolVec<Watcher>&  wbin = watches_bin[p];
 
         for (int k = 0; k<wbin.size(); k++)
         {
@@ -276,19 +364,21 @@ CRef Solver::simplePropagate()
             //}
             else
             {  // ----------------- DEFAULT  MODE (NOT INCREMENTAL)
-                for (int k = 2; k < c.size(); k++)
-                {
+                int k = 2;
+                if (simd_watch_min > 0 && c.size() >= simd_watch_min)
+                    k = findWatchWide(&c[0], 2, c.size(), lit_assigns);
+                else
+                    while (k < c.size() && value(c[k]) == l_False) k++;
 
-                    if (value(c[k]) != l_False)
-                    {
-                        // watcher i is abandonned using i++, because cr watches now ~c[k] instead of p
-                        // the blocker is first in the watcher. However,
-                        // the blocker in the corresponding watcher in ~first is not c[1]
-                        Watcher w = Watcher(cr, first); i++;
-                        c[1] = c[k]; c[k] = false_lit;
-                        watches[~c[1]].push(w);
-                        goto NextClause;
-                    }
+                if (k < c.size())
+                {
+                    // watcher i is abandonned using i++, because cr watches now ~c[k] instead of p
+                    // the blocker is first in the watcher. However,
+                    // the blocker in the corresponding watcher in ~first is not c[1]
+                    Watcher w = Watcher(cr, first); i++;
+                    c[1] = c[k]; c[k] = false_lit;
+                    watches[~c[1]].push(w);
+                    goto NextClause;
                 }
             }
 
@@ -312,14 +402,14 @@ NextClause:;
         ws.shrink(i - j);
     }
 
-    s_propagations += num_props;
-
     return confl;
 }
 
 void Solver::simpleUncheckEnqueue(Lit p, CRef from){
     assert(value(p) == l_Undef);
     assigns[var(p)] = lbool(!sign(p)); // this makes a lbool object whose value is sign(p)
+    lit_assigns[toInt(p)] = l_True;
+    lit_assigns[toInt(~p)] = l_False;
     vardata[var(p)].reason = from;
     trail.push_(p);
 }
@@ -330,6 +420,7 @@ void Solver::cancelUntilTrailRecord()
     {
         Var x = var(trail[c]);
         assigns[x] = l_Undef;
+        lit_assigns[toInt(trail[c])] = lit_assigns[toInt(~trail[c])] = l_Undef;
 
     }
     qhead = trailRecord;
@@ -458,6 +549,7 @@ void Solver::simplifyLearnt(Clause& c)
     }
 
     cancelUntilTrailRecord();
+    c.calcFingerprint();
 
     ////
     simplified_length_record += c.size();
@@ -574,346 +666,1223 @@ bool Solver::simplifyLearnt_x(vec<CRef>& learnts_x)
     return true;
 }
 
-bool Solver::simplifyLearnt_core()
-{
-    int beforeSize, afterSize;
-    int learnts_core_size_before = learnts_core.size();
+int Solver::is_duplicate(uint64_t fp){
+    dupl_db_size++;
 
-    int ci, cj, li, lj;
-    bool sat, false_lit;
-    unsigned int nblevels;
-    ////
-    //printf("learnts_x size : %d\n", learnts_x.size());
+    uint32_t& count = dup_table[fp != 0 ? fp : 1];
+    if (count == 0){
+        count = 1;
+        return 0; }
+    return ++count;
+}
 
-    ////
-    int nbSimplified = 0;
-    int nbSimplifing = 0;
+// Vivifies one learnt clause. Returns FALSE if it shrank to a unit that propagates
+// to a conflict.
+bool Solver::vivifyLearnt(CRef cr)
+{
+    Clause& c = ca[cr];
+    int saved_size = c.size();
+    bool sat = false, false_lit = false;
+    for (int i = 0; i < c.size(); i++){
+        if (value(c[i]) == l_True){
+            sat = true;
+            break;
+        }
+        else if (value(c[i]) == l_False){
+            false_lit = true;
+        }
+    }
+    if (sat){
+        removeClause(cr);
+        return true;
+    }
 
-    for (ci = 0, cj = 0; ci < learnts_core.size(); ci++){
-        CRef cr = learnts_core[ci];
-        Clause& c = ca[cr];
+    detachClause(cr, true);
 
-        if (removed(cr)) continue;
-        else if (c.simplified()){
-            learnts_core[cj++] = learnts_core[ci];
-            ////
-            nbSimplified++;
-        }
-        else{
-            int saved_size=c.size();
-            //         if (drup_file){
-            //                 add_oc.clear();
-            //                 for (int i = 0; i < c.size(); i++) add_oc.push(c[i]); }
-            ////
-            nbSimplifing++;
-            sat = false_lit = false;
-            for (int i = 0; i < c.size(); i++){
-                if (value(c[i]) == l_True){
-                    sat = true;
-                    break;
-                }
-                else if (value(c[i]) == l_False){
-                    false_lit = true;
-                }
-            }
-            if (sat){
-                removeClause(cr);
+    if (false_lit){
+        int li, lj;
+        for (li = lj = 0; li < c.size(); li++){
+            if (value(c[li]) != l_False){
+                c[lj++] = c[li];
             }
-            else{
-                detachClause(cr, true);
+        }
+        c.shrink(li - lj);
+    }
 
-                if (false_lit) {
-                    for (li = lj = 0; li < c.size(); li++){
-                        if (value(c[li]) != l_False){
-                            c[lj++] = c[li];
-                        }
-                    }
-                    c.shrink(li - lj);
-                }
+    assert(c.size() > 1);
+    // simplify a learnt clause c
+    simplifyLearnt(c);
+    assert(c.size() > 0);
 
-                beforeSize = c.size();
-                assert(c.size() > 1);
-                // simplify a learnt clause c
-                simplifyLearnt(c);
-                assert(c.size() > 0);
-                afterSize = c.size();
-                
-                if(drup_file && saved_size !=c.size()){
+    if (drup_file && saved_size != c.size()){
 #ifdef BIN_DRUP
-                    binDRUP('a', c , drup_file);
-                    //                    binDRUP('d', add_oc, drup_file);
+        binDRUP('a', c , drup_file);
 #else
-                    for (int i = 0; i < c.size(); i++)
-                        fprintf(drup_file, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
-                    fprintf(drup_file, "0\n");
-
-                    //                    fprintf(drup_file, "d ");
-                    //                    for (int i = 0; i < add_oc.size(); i++)
-                    //                        fprintf(drup_file, "%i ", (var(add_oc[i]) + 1) * (-2 * sign(add_oc[i]) + 1));
-                    //                    fprintf(drup_file, "0\n");
+        for (int i = 0; i < c.size(); i++)
+            fprintf(drup_file, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
+        fprintf(drup_file, "0\n");
 #endif
-                }
+    }
 
-                //printf("beforeSize: %2d, afterSize: %2d\n", beforeSize, afterSize);
+    if (c.size() == 1){
+        // when unit clause occur, enqueue and propagate
+        uncheckedEnqueue(c[0]);
+        if (propagate() != CRef_Undef){
+            ok = false;
+            return false;
+        }
+        // delete the clause memory in logic
+        c.mark(1);
+        ca.free(cr);
+        return true;
+    }
 
-                if (c.size() == 1){
-                    // when unit clause occur, enqueue and propagate
-                    uncheckedEnqueue(c[0]);
-                    if (propagate() != CRef_Undef){
-                        ok = false;
-                        return false;
-                    }
-                    // delete the clause memory in logic
-                    c.mark(1);
-                    ca.free(cr);
-//#ifdef BIN_DRUP
-//                    binDRUP('d', c, drup_file);
-//#else
-//                    fprintf(drup_file, "d ");
-//                    for (int i = 0; i < c.size(); i++)
-//                        fprintf(drup_file, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
-//                    fprintf(drup_file, "0\n");
-//#endif
-                }
-                else{
-                    attachClause(cr);
-                    learnts_core[cj++] = learnts_core[ci];
+    unsigned int nblevels = computeLBD(c);
+    if (nblevels < c.lbd())
+        c.set_lbd(nblevels);
+
+    if (c.mark() == TIER2){
+        //duplicate learnts
+        int id = is_duplicate(c.fingerprint());
+        if (id >= min_number_of_learnts_copies+2){
+            // Seen often enough that it is already in the core tier:
+            c.mark(1);
+            ca.free(cr);
+            return true; }
+        if (id == min_number_of_learnts_copies+1)
+            duplicates_added_minimization++;
+        if ((c.lbd() <= core_lbd_cut)||(id == min_number_of_learnts_copies+1)){
+            learnts_core.push(cr);
+            c.mark(CORE); }
+        //duplicate learnts
+    }
 
-                    nblevels = computeLBD(c);
-                    if (nblevels < c.lbd()){
-                        //printf("lbd-before: %d, lbd-after: %d\n", c.lbd(), nblevels);
-                        c.set_lbd(nblevels);
-                    }
+    attachClause(cr);
+    c.setSimplified(true);
+    return true;
+}
 
-                    c.setSimplified(true);
-                }
+bool Solver::simplifyAll()
+{
+    ////
+    simplified_length_record = original_length_record = 0;
+
+    if (!ok || propagate() != CRef_Undef)
+        return ok = false;
+
+    if (subst_equiv && !substituteEquivalences())
+        return ok = false;
+
+    uint64_t search_props = propagations - vivify_props;
+    if (transred_effort > 0 && !transitiveReduction(bin_ticks + (uint64_t)(transred_effort * search_props)))
+        return ok = false;
+    if (probe_effort > 0 && !probe(s_propagations + (uint64_t)(probe_effort * search_props)))
+        return ok = false;
+    if (subsume_effort > 0 && !subsumeLearnts(subsume_ticks + (uint64_t)(subsume_effort * search_props)))
+        return ok = false;
+
+    //// cleanLearnts(also can delete these code), here just for analyzing
+    //if (local_learnts_dirty) cleanLearnts(learnts_local, LOCAL);
+    //if (tier2_learnts_dirty) cleanLearnts(learnts_tier2, TIER2);
+    //local_learnts_dirty = tier2_learnts_dirty = false;
+
+    // Vivify the clauses of the core and tier2 tiers not done yet, best first, until the budget runs
+    // out; the rest wait for the next call. With a helper thread, they all go to the helper once it
+    // is idle:
+    if (vivifier == NULL || !vivifier->busy()){
+        vivify_queue.clear();
+        for (int i = 0; i < learnts_core.size(); i++){
+            Clause& c = ca[learnts_core[i]];
+            if (c.mark() == CORE && !c.simplified()) vivify_queue.push(learnts_core[i]); }
+        for (int i = 0; i < learnts_tier2.size(); i++){
+            Clause& c = ca[learnts_tier2[i]];
+            if (c.mark() == TIER2 && !c.simplified()) vivify_queue.push(learnts_tier2[i]); }
+        sort(vivify_queue, VivifyLt(ca));
+    }
+
+    if (vivifier != NULL){
+        if (!vivifier->busy()) startVivifier();
+    }else{
+        uint64_t budget = s_propagations + (uint64_t)(vivify_effort * search_props);
+        for (int i = 0; i < vivify_queue.size() && s_propagations < budget; i++){
+            CRef cr = vivify_queue[i];
+            if (removed(cr) || ca[cr].simplified()) continue;   // (listed twice in 'learnts_tier2')
+            if (!vivifyLearnt(cr)) return ok = false; }
+        cleanTiers();
+    }
+
+    // Vivifying the whole local tier costs too much, and half of it goes at the next 'reduceDB()'
+    // anyway. Only vivify the clauses that will survive it: the more active half, and those used
+    // in a conflict since the last reduction. The most active go first:
+    if (vivify_local > 0){
+        vivify_queue.clear();
+        for (int i = 0; i < learnts_local.size(); i++)
+            if (ca[learnts_local[i]].mark() == LOCAL) vivify_queue.push(learnts_local[i]);
+        sort(vivify_queue, ActivityGt(ca));
+        int i, j, keep = vivify_queue.size() / 2;
+        for (i = j = 0; i < vivify_queue.size(); i++){
+            Clause& c = ca[vivify_queue[i]];
+            if ((i < keep || !c.removable()) && !c.simplified())
+                vivify_queue[j++] = vivify_queue[i]; }
+        vivify_queue.shrink(i - j);
+
+        uint64_t budget = s_propagations + (uint64_t)(vivify_local * search_props);
+        for (i = 0; i < vivify_queue.size() && s_propagations < budget; i++)
+            if (!vivifyLearnt(vivify_queue[i])) return ok = false;
+
+        // Drop the clauses the pass deleted, so that nothing relocates them until 'reduceDB()':
+        for (i = j = 0; i < learnts_local.size(); i++)
+            if (ca[learnts_local[i]].mark() == LOCAL)
+                learnts_local[j++] = learnts_local[i];
+        learnts_local.shrink(i - j);
+    }
+    vivify_props = propagations;
+
+    checkGarbage();
+
+    ////
+    //  printf("c size_reduce_ratio     : %4.2f%%\n",
+    //         original_length_record == 0 ? 0 : (original_length_record - simplified_length_record) * 100 / (double)original_length_record);
+
+    return true;
+}
+
+// Drops deleted clauses from the original clauses and the core tier, and deleted, moved or repeated
+// clauses from the tier2 tier (see the "Bug:" in 'analyze()').
+void Solver::cleanTiers()
+{
+    int i, j;
+    for (i = j = 0; i < clauses.size(); i++)
+        if (!removed(clauses[i]))
+            clauses[j++] = clauses[i];
+    clauses.shrink(i - j);
+    for (i = j = 0; i < learnts_core.size(); i++)
+        if (!removed(learnts_core[i]))
+            learnts_core[j++] = learnts_core[i];
+    learnts_core.shrink(i - j);
+    // The first occurrence of a clause marks it LOCAL for the moment, so that any later ones fail
+    // the test:
+    for (i = j = 0; i < learnts_tier2.size(); i++)
+        if (ca[learnts_tier2[i]].mark() == TIER2){
+            ca[learnts_tier2[i]].mark(LOCAL);
+            learnts_tier2[j++] = learnts_tier2[i]; }
+    learnts_tier2.shrink(i - j);
+    for (i = 0; i < learnts_tier2.size(); i++)
+        ca[learnts_tier2[i]].mark(TIER2);
+}
+
+
+// Sends the clauses that a pass between restarts added or rewrote, and the units it found, to redis.
+// Each pass does so as soon as it is done, since the next ones, vivification above all, may delete
+// some of these clauses again. Queued clauses that are already deleted are dropped.
+void Solver::exportNewClauses()
+{
+    int i, j;
+    vec<CRef>& exp = redis->learnts;
+    for (i = j = 0; i < exp.size(); i++)
+        if (ca[exp[i]].mark() != 1)
+            exp[j++] = exp[i];
+    exp.shrink(i - j);
+    redis->save_learnts();
+}
+
+
+// Hands the clauses of 'vivify_queue' to the helper thread, together with everything they may be
+// vivified against: the level 0 units, the original clauses and the rest of the core and tier2
+// tiers. Must be called at decision level 0.
+void Solver::startVivifier()
+{
+    assert(decisionLevel() == 0 && !vivifier->busy());
+    if (vivify_queue.size() == 0) return;
+
+    // The copy of the original clauses is taken again once any of them was deleted or rewritten
+    // (by substitution, transitive reduction, elimination, ...), as the proof has deleted them too:
+    Vivifier& v = *vivifier;
+    if (v.hasBase() && original_changes != vivify_base_epoch)
+        v.dropBase();
+    v.clear(nVars());
+    if (!v.hasBase()){
+        for (int i = 0; i < clauses.size(); i++){
+            const Clause& c = ca[clauses[i]];
+            if (c.mark() != 1) v.addClause(c, c.size()); }
+        v.setBase();
+        vivify_base_epoch = original_changes; }
+
+    for (int i = 0; i < trail.size(); i++)
+        v.addUnit(trail[i]);
+    for (int i = 0; i < learnts_core.size(); i++){
+        Clause& c = ca[learnts_core[i]];
+        if (c.mark() == CORE && c.simplified()) v.addClause(c, c.size()); }
+    for (int i = 0; i < learnts_tier2.size(); i++){
+        Clause& c = ca[learnts_tier2[i]];
+        if (c.mark() == TIER2 && c.simplified()) v.addClause(c, c.size()); }
+    for (int i = 0; i < vivify_queue.size(); i++){
+        Clause& c = ca[vivify_queue[i]];
+        if (c.simplified()) continue;                       // (listed twice in 'learnts_tier2')
+        v.addTarget(c, c.size(), c.fingerprint());
+        c.setSimplified(true); }
+
+    vivify_epoch = clause_deletions;
+    v.start();
+}
+
+
+// Takes over the clauses shortened by the helper thread, and deletes the tier2 clauses that the
+// rest of its snapshot implied. Must be called at decision level 0. Returns FALSE if a shortened
+// clause is false under the current assignment.
+bool Solver::applyVivified()
+{
+    assert(decisionLevel() == 0);
+    Vivifier& v = *vivifier;
+    v.collect();
+
+    // A proof checker must derive each shortened clause by unit propagation, which only works as
+    // long as the clauses the helper derived it from are still there:
+    if (drup_file && clause_deletions != vivify_epoch) return true;
+
+    vec<Lit>  ps;
+    vec<CRef> redundant;
+    for (int t = 0; t < 2; t++){
+        vec<CRef>& cs   = t == 0 ? learnts_core : learnts_tier2;
+        unsigned   mark = t == 0 ? CORE : TIER2;
+        for (int i = 0; i < cs.size(); i++){
+            CRef    cr = cs[i];
+            Clause& c  = ca[cr];
+            if (c.mark() != mark) continue;
+
+            // Find the result (if any) by fingerprint:
+            uint64_t fp = c.fingerprint();
+            int lo = 0, hi = v.results.size();
+            while (lo < hi){
+                int mid = (lo + hi) / 2;
+                if (v.results[mid].fp < fp) lo = mid + 1; else hi = mid; }
+            if (lo == v.results.size() || v.results[lo].fp != fp) continue;
+            Vivifier::Result& r = v.results[lo];
+
+            // Fingerprints may collide; a result only belongs to a clause it is a strict subset of:
+            if (r.size >= c.size()) continue;
+            for (int j = 0; j < c.size(); j++) seen[var(c[j])] = 1 + sign(c[j]);
+            bool subset = true;
+            for (int j = 0; j < r.size && subset; j++){
+                Lit p = v.result_lits[r.start + j];
+                subset = seen[var(p)] == 1 + sign(p); }
+            for (int j = 0; j < c.size(); j++) seen[var(c[j])] = 0;
+            if (!subset) continue;
+
+            if (r.size <= 0){
+                // Redundant: delete it once (copies would each be implied by the other). The core
+                // tier is kept for propagation.
+                if (r.size == 0 && mark == TIER2 && !locked(c)){
+                    redundant.push(cr);
+                    r.size = -1; }
+                continue; }
+
+            bool sat = false;
+            ps.clear();
+            for (int j = 0; j < r.size && !sat; j++){
+                Lit p = v.result_lits[r.start + j];
+                if      (value(p) == l_True)  sat = true;
+                else if (value(p) == l_Undef) ps.push(p); }
+            if (sat || ps.size() >= c.size()) continue;
+            if (ps.size() == 0) return ok = false;
+
+            detachClause(cr, true);
+            for (int j = 0; j < ps.size(); j++)
+                c[j] = ps[j];
+            c.shrink(c.size() - ps.size());
+            c.calcFingerprint();
+            if (c.lbd() > c.size()) c.set_lbd(c.size());
+
+            if (drup_file){
+#ifdef BIN_DRUP
+                binDRUP('a', c, drup_file);
+#else
+                for (int j = 0; j < c.size(); j++)
+                    fprintf(drup_file, "%i ", (var(c[j]) + 1) * (-2 * sign(c[j]) + 1));
+                fprintf(drup_file, "0\n");
+#endif
             }
+
+            if (c.size() == 1){
+                uncheckedEnqueue(c[0]);
+                c.mark(1);
+                ca.free(cr);
+            }else
+                attachClause(cr);
         }
     }
-    learnts_core.shrink(ci - cj);
 
-    //    printf("c nbLearnts_core %d / %d, nbSimplified: %d, nbSimplifing: %d\n",
-    //           learnts_core_size_before, learnts_core.size(), nbSimplified, nbSimplifing);
+    // The helper may have shortened a clause with the help of one it found redundant later, so the
+    // redundant ones leave the proof only after all shortened clauses are in:
+    for (int i = 0; i < redundant.size(); i++)
+        removeClause(redundant[i]);
+    cleanTiers();
+
+    return ok = propagate() == CRef_Undef;
+}
+
+//=================================================================================================
+// Equivalent literal substitution:
 
-    return true;
 
+// Replaces every literal of 'ps' by its representative and removes the duplicates this creates.
+// Returns FALSE if 'ps' became a tautology.
+bool Solver::substitute(vec<Lit>& ps)
+{
+    for (int i = 0; i < ps.size(); i++)
+        ps[i] = substLit(ps[i]);
+    sort(ps);
+    int i, j;
+    Lit p;
+    for (i = j = 0, p = lit_Undef; i < ps.size(); i++)
+        if (ps[i] == ~p)
+            return false;
+        else if (ps[i] != p)
+            ps[j++] = p = ps[i];
+    ps.shrink(i - j);
+    return true;
 }
 
 
-int Solver::is_duplicate(std::vector<uint32_t>&c){
-    auto time_point_0 = std::chrono::high_resolution_clock::now();
-    dupl_db_size++;
-    int res = 0;    
-    
-    int sz = c.size();
-    std::vector<uint32_t> tmp(c);    
-    sort(tmp.begin(),tmp.end());
-    
-    uint64_t hash = 0;    
-    
-    for (int i =0; i<sz; i++) {
-        hash ^= tmp[i] + 0x9e3779b9 + (hash << 6) + (hash>> 2);     
-    }    
-    
-    uint32_t head = tmp[0];
-    auto it0 = ht.find(head);
-    if (it0 != ht.end()){
-        auto it1=ht[head].find(sz);
-        if (it1 != ht[head].end()){
-            auto it2 = ht[head][sz].find(hash);
-            if (it2 != ht[head][sz].end()){
-                it2->second++;
-                res = it2->second;            
+// Finds the strongly connected components of the binary implication graph (Tarjan's algorithm,
+// without recursion) and replaces the literals of each component by the one with the smallest
+// variable. Since the components of 'p' and '~p' mirror each other, so do their representatives.
+// Assigned literals are left out. Sets 'found' to the number of variables replaced.
+bool Solver::findEquivalences(int& found)
+{
+    struct Frame { Lit p; int next; };
+    vec<int>   index(2 * nVars(), 0), low(2 * nVars(), 0);
+    vec<char>  on_stack(2 * nVars(), 0);
+    vec<Lit>   stack, scc;
+    vec<Frame> dfs;
+    int        counter = 0;
+
+    found = 0;
+    for (int r = 0; r < 2 * nVars(); r++){
+        Lit root = toLit(r);
+        if (index[r] != 0 || value(root) != l_Undef || subst[var(root)] != lit_Undef) continue;
+
+        Frame f = { root, 0 };
+        dfs.push(f);
+        index[r] = low[r] = ++counter;
+        stack.push(root);
+        on_stack[r] = 1;
+
+        while (dfs.size() > 0){
+            Lit               p  = dfs.last().p;
+            PoolVec<Watcher>& ws = watches_bin[p];   // Edges 'p -> q' for each binary clause '~p | q'.
+            if (dfs.last().next < ws.size()){
+                const Watcher& w = ws[dfs.last().next++];
+                Lit q = w.blocker;
+                if (ca[w.cref].mark() == 1 || value(q) != l_Undef) continue;
+                if (index[toInt(q)] == 0){
+                    Frame g = { q, 0 };
+                    dfs.push(g);
+                    index[toInt(q)] = low[toInt(q)] = ++counter;
+                    stack.push(q);
+                    on_stack[toInt(q)] = 1;
+                }else if (on_stack[toInt(q)] && index[toInt(q)] < low[toInt(p)])
+                    low[toInt(p)] = index[toInt(q)];
+                continue; }
+
+            dfs.pop();
+            if (dfs.size() > 0 && low[toInt(p)] < low[toInt(dfs.last().p)])
+                low[toInt(dfs.last().p)] = low[toInt(p)];
+            if (low[toInt(p)] != index[toInt(p)]) continue;
+
+            // 'p' is the root of a component:
+            Lit q;
+            scc.clear();
+            do{
+                q = stack.last();
+                stack.pop();
+                on_stack[toInt(q)] = 0;
+                scc.push(q);
+            }while (q != p);
+            if (scc.size() == 1) continue;
+
+            Lit rep = scc[0];
+            for (int i = 1; i < scc.size(); i++)
+                if (var(scc[i]) < var(rep)) rep = scc[i];
+            for (int i = 0; i < scc.size(); i++)
+                if (var(scc[i]) == var(rep) && scc[i] != rep){
+                    // 'rep' implies its own negation and vice versa:
+                    if (drup_file){
+                        add_tmp.clear();
+                        add_tmp.push(~rep);
+#ifdef BIN_DRUP
+                        binDRUP('a', add_tmp, drup_file);
+#else
+                        fprintf(drup_file, "%i 0\n", (var(rep) + 1) * (2 * sign(rep) - 1));
+#endif
+                    }
+                    return false; }
+            for (int i = 0; i < scc.size(); i++){
+                Var v = var(scc[i]);
+                if (v != var(rep) && subst[v] == lit_Undef){
+                    subst[v] = rep ^ sign(scc[i]);
+                    found++; }
             }
-            else{
-                ht[head][sz][hash]=1;
+        }
+    }
+    return true;
+}
+
+
+// Replaces equivalent literals in all clauses, at decision level 0. The replaced variables no longer
+// occur in any clause; they stop being decision variables and take their value in the model from
+// their representative. Returns FALSE if the formula turned out unsatisfiable.
+bool Solver::substituteEquivalences()
+{
+    assert(decisionLevel() == 0 && qhead == trail.size());
+    int found;
+    if (!findEquivalences(found)) return false;
+    if (found == 0) return true;
+
+    for (int v = 0; v < nVars(); v++)
+        if (subst[v] != lit_Undef && decision[v]) setDecisionVar(v, false);
+    substituted += found;
+    xor_stale = use_xor;                // (the matrices may hold the variables replaced)
+
+    // A clause that 'learnts_tier2' holds twice would be rewritten or removed twice:
+    cleanTiers();
+
+    // Compute the new clauses first. A proof checker derives each by unit propagation over the
+    // binary clauses of the components, so these must only be deleted after all are added:
+    struct Rewrite { CRef cr; int start, size; };   // 'size' is -1 if the clause is satisfied.
+    vec<Rewrite> rewrites;
+    vec<Lit>     lits, ps;
+    for (int t = 0; t < 4; t++){
+        vec<CRef>& cs   = t == 0 ? clauses : t == 1 ? learnts_core : t == 2 ? learnts_tier2 : learnts_local;
+        unsigned   mark = t == 0 ? 0 : t == 1 ? CORE : t == 2 ? TIER2 : LOCAL;
+        for (int i = 0; i < cs.size(); i++){
+            const Clause& c = ca[cs[i]];
+            if (c.mark() != mark) continue;
+            int k = 0;
+            while (k < c.size() && subst[var(c[k])] == lit_Undef) k++;
+            if (k == c.size()) continue;
+
+            ps.clear();
+            bool sat = false;
+            for (k = 0; k < c.size() && !sat; k++)
+                if      (value(c[k]) == l_True)  sat = true;
+                else if (value(c[k]) == l_Undef) ps.push(c[k]);
+            sat = sat || !substitute(ps);
+            Rewrite r = { cs[i], lits.size(), sat ? -1 : ps.size() };
+            rewrites.push(r);
+            if (sat) continue;
+            for (k = 0; k < ps.size(); k++)
+                lits.push(ps[k]);
+
+            if (drup_file){
+#ifdef BIN_DRUP
+                binDRUP('a', ps, drup_file);
+#else
+                for (k = 0; k < ps.size(); k++)
+                    fprintf(drup_file, "%i ", (var(ps[k]) + 1) * (-2 * sign(ps[k]) + 1));
+                fprintf(drup_file, "0\n");
+#endif
             }
+            if (ps.size() == 0) return false;
         }
-        else{            
-            ht[head][sz][hash]=1;
+    }
+
+    // Now replace the old clauses:
+    for (int i = 0; i < rewrites.size(); i++){
+        const Rewrite& r = rewrites[i];
+        Clause& c = ca[r.cr];
+        if (r.size < 2){
+            if (r.size == 1){
+                Lit p = lits[r.start];
+                if      (value(p) == l_False) return false;
+                else if (value(p) == l_Undef) uncheckedEnqueue(p); }
+            removeClause(r.cr);
+            continue; }
+
+        detachClause(r.cr, true);
+        clause_deletions++;
+        if (!c.learnt()) original_changes++;
+        if (drup_file){
+#ifdef BIN_DRUP
+            binDRUP('d', c, drup_file);
+#else
+            fprintf(drup_file, "d ");
+            for (int k = 0; k < c.size(); k++)
+                fprintf(drup_file, "%i ", (var(c[k]) + 1) * (-2 * sign(c[k]) + 1));
+            fprintf(drup_file, "0\n");
+#endif
         }
-    }else{        
-        ht[head][sz][hash]=1;
-    } 
-    auto time_point_1 = std::chrono::high_resolution_clock::now();
-    duptime += std::chrono::duration_cast<std::chrono::microseconds>(time_point_1-time_point_0);    
-    return res;
+        for (int k = 0; k < r.size; k++)
+            c[k] = lits[r.start + k];
+        c.shrink(c.size() - r.size);
+        if (c.learnt()){
+            c.calcFingerprint();
+            if (c.lbd() > c.size()) c.set_lbd(c.size()); }
+        attachClause(r.cr);
+    }
+    cleanTiers();
+
+    if (verbosity > 1)
+        fprintf(stderr, "c Substituted %d equivalent literals, %d clauses rewritten\n", found, rewrites.size());
+
+    exportNewClauses();
+
+    return propagate() == CRef_Undef;
 }
 
-bool Solver::simplifyLearnt_tier2()
+//=================================================================================================
+// Transitive reduction and probing of the binary implication graph:
+//
+// An edge 'p -> q' stands for the binary clause '~p | q', which is watched in 'watches_bin[p]'.
+
+
+// Starts a new search of the binary implication graph: literals stamped before count as unvisited.
+void Solver::nextBinStamp()
 {
-    int beforeSize, afterSize;
-    int learnts_tier2_size_before = learnts_tier2.size();
+    if (++bin_stamp_cur == 0){
+        for (int i = 0; i < bin_stamp.size(); i++) bin_stamp[i] = 0;
+        bin_stamp_cur = 1; }
+    bin_stamp.growTo(2 * nVars(), 0);
+}
 
-    int ci, cj, li, lj;
-    bool sat, false_lit;
-    unsigned int nblevels;
-    ////
-    //printf("learnts_x size : %d\n", learnts_x.size());
 
-    ////
-    int nbSimplified = 0;
-    int nbSimplifing = 0;
+// Searches the binary implication graph depth first from 'from', leaving out the edge of clause
+// 'skip', and with 'irredundant' the edges of learnt clauses too. Returns 'to' if it is reachable,
+// '~from' if that is reachable instead (so that 'from' fails), and 'lit_Undef' otherwise. Counts
+// the edges visited in 'bin_ticks'.
+Lit Solver::binReach(Lit from, Lit to, CRef skip, bool irredundant)
+{
+    nextBinStamp();
+    add_tmp.clear();
+    add_tmp.push(from);
+    bin_stamp[toInt(from)] = bin_stamp_cur;
+    while (add_tmp.size() > 0){
+        Lit p = add_tmp.last();
+        add_tmp.pop();
+        PoolVec<Watcher>& ws = watches_bin[p];
+        bin_ticks += 1 + ws.size();
+        for (int k = 0; k < ws.size(); k++){
+            Lit q = ws[k].blocker;
+            if (bin_stamp[toInt(q)] == bin_stamp_cur || value(q) != l_Undef || ws[k].cref == skip) continue;
+            const Clause& c = ca[ws[k].cref];
+            if (c.mark() == 1) continue;                // (removed during this pass)
+            if (irredundant && c.learnt()) continue;
+            if (q == to || q == ~from) return q;
+            bin_stamp[toInt(q)] = bin_stamp_cur;
+            add_tmp.push(q); }
+    }
+    return lit_Undef;
+}
 
-    for (ci = 0, cj = 0; ci < learnts_tier2.size(); ci++){
-        CRef cr = learnts_tier2[ci];
-        Clause& c = ca[cr];
 
-        if (removed(cr)) continue;
-        else if (c.simplified()){
-            learnts_tier2[cj++] = learnts_tier2[ci];
-            ////
-            nbSimplified++;
-        }
-        else{
-            int saved_size=c.size();
-            //            if (drup_file){
-            //                    add_oc.clear();
-            //                    for (int i = 0; i < c.size(); i++) add_oc.push(c[i]); }
-            ////
-            nbSimplifing++;
-            sat = false_lit = false;
-            for (int i = 0; i < c.size(); i++){
-                if (value(c[i]) == l_True){
-                    sat = true;
-                    break;
-                }
-                else if (value(c[i]) == l_False){
-                    false_lit = true;
-                }
-            }
-            if (sat){
+// Removes binary clauses whose implication also follows from a path through the others, until
+// 'bin_ticks' reaches 'budget'; the next call continues where this one stopped. A search that leads
+// from a literal to its negation yields a unit instead. Must be called at decision level 0 with
+// everything propagated. Returns FALSE if the formula turned out unsatisfiable.
+bool Solver::transitiveReduction(uint64_t budget)
+{
+    assert(decisionLevel() == 0 && qhead == trail.size());
+    watches_bin.cleanAll();
+    for (int n = 0; n < 2 * nVars() && bin_ticks < budget; n++){
+        Lit src = toLit(transred_next);
+        transred_next = (transred_next + 1) % (2 * nVars());
+        if (value(src) != l_Undef) continue;
+
+        PoolVec<Watcher>& ws = watches_bin[src];
+        for (int i = 0; i < ws.size() && bin_ticks < budget; i++){
+            CRef          cr = ws[i].cref;
+            const Clause& c  = ca[cr];
+            // Each clause '~src | q' once, from the watcher of its first literal:
+            if (c.mark() == 1 || c[0] != ~src || value(c[1]) != l_Undef) continue;
+
+            // An original clause may only go for a path of original clauses, since learnt clauses
+            // can be deleted later (and take the implication with them):
+            Lit reached = binReach(src, c[1], cr, !c.learnt());
+            if (reached == c[1]){
                 removeClause(cr);
-            }
-            else{
-                detachClause(cr, true);
-
-                if (false_lit){
-                    for (li = lj = 0; li < c.size(); li++){
-                        if (value(c[li]) != l_False){
-                            c[lj++] = c[li];
-                        }
-                    }
-                    c.shrink(li - lj);
+                transred_removed++;
+            }else if (reached == ~src){
+                if (drup_file){
+                    add_tmp.clear();
+                    add_tmp.push(~src);
+#ifdef BIN_DRUP
+                    binDRUP('a', add_tmp, drup_file);
+#else
+                    fprintf(drup_file, "%i 0\n", (var(src) + 1) * (2 * sign(src) - 1));
+#endif
                 }
+                uncheckedEnqueue(~src);
+                if (propagate() != CRef_Undef) return false;
+                break; }
+        }
+    }
+    cleanTiers();
+    return true;
+}
 
-                beforeSize = c.size();
-                assert(c.size() > 1);
-                // simplify a learnt clause c
-                simplifyLearnt(c);
-                assert(c.size() > 0);
-                afterSize = c.size();
-                
-                if(drup_file && saved_size!=c.size()){
 
+// Lowest common ancestor of 'p' and 'q' in the implication tree of the current probe.
+Lit Solver::probeDominator(Lit p, Lit q) const
+{
+    while (p != q)
+        if (probe_depth[var(p)] > probe_depth[var(q)]) p = probe_parent[var(p)];
+        else                                           q = probe_parent[var(q)];
+    return p;
+}
+
+
+// Propagates 'r' on top of level 0. Every literal it implies through a longer clause gets a
+// hyper-binary resolvent: the binary clause between it and the closest literal that dominates the
+// other literals of that clause in the implication tree of the probe. If 'r' fails, its negation
+// becomes a unit instead. Returns FALSE if the formula turned out unsatisfiable.
+bool Solver::probeRoot(Lit r)
+{
+    trailRecord = trail.size();
+    simpleUncheckEnqueue(r);
+    CRef confl = simplePropagate();
+
+    probe_hbr.clear();
+    if (confl == CRef_Undef){
+        // The trail lists every literal after the literals of its reason, so the tree grows in order:
+        probe_parent[var(r)] = lit_Undef;
+        probe_depth [var(r)] = 0;
+        seen[var(r)] = 1;
+        for (int i = trailRecord + 1; i < trail.size(); i++){
+            Lit     q   = trail[i];
+            Clause& c   = ca[reason(var(q))];
+            Lit     dom = lit_Undef;
+            for (int k = 0; k < c.size(); k++)
+                if (c[k] != q && seen[var(c[k])])          // (the others are false at level 0)
+                    dom = dom == lit_Undef ? ~c[k] : probeDominator(dom, ~c[k]);
+            if (dom == lit_Undef) dom = r;
+            else if (c.size() > 2){
+                probe_hbr.push(~dom);
+                probe_hbr.push(q); }
+            probe_parent[var(q)] = dom;
+            probe_depth [var(q)] = probe_depth[var(dom)] + 1;
+            seen[var(q)] = 1; }
+        for (int i = trailRecord; i < trail.size(); i++)
+            seen[var(trail[i])] = 0;
+    }
+    cancelUntilTrailRecord();
+
+    if (confl != CRef_Undef){
+        probe_failed++;
+        if (drup_file){
+            add_tmp.clear();
+            add_tmp.push(~r);
 #ifdef BIN_DRUP
-                    binDRUP('a', c , drup_file);
-                    //                    binDRUP('d', add_oc, drup_file);
+            binDRUP('a', add_tmp, drup_file);
 #else
-                    for (int i = 0; i < c.size(); i++)
-                        fprintf(drup_file, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
-                    fprintf(drup_file, "0\n");
-
-                    //                    fprintf(drup_file, "d ");
-                    //                    for (int i = 0; i < add_oc.size(); i++)
-                    //                        fprintf(drup_file, "%i ", (var(add_oc[i]) + 1) * (-2 * sign(add_oc[i]) + 1));
-                    //                    fprintf(drup_file, "0\n");
+            fprintf(drup_file, "%i 0\n", (var(r) + 1) * (2 * sign(r) - 1));
 #endif
-                }
+        }
+        uncheckedEnqueue(~r);
+        return propagate() == CRef_Undef; }
+
+    // In the order found, each resolvent follows by unit propagation from the clauses before it. They
+    // go to the tier2 tier, so those that no conflict uses get reduced eventually:
+    vec<Lit> ps;
+    for (int i = 0; i < probe_hbr.size(); i += 2){
+        ps.clear();
+        ps.push(probe_hbr[i + 1]);
+        ps.push(probe_hbr[i]);
+        if (drup_file){
+#ifdef BIN_DRUP
+            binDRUP('a', ps, drup_file);
+#else
+            for (int k = 0; k < ps.size(); k++)
+                fprintf(drup_file, "%i ", (var(ps[k]) + 1) * (-2 * sign(ps[k]) + 1));
+            fprintf(drup_file, "0\n");
+#endif
+        }
+        CRef cr = ca.alloc(ps, true);
+        Clause& c = ca[cr];
+        c.set_lbd(2);
+        c.calcFingerprint();
+        c.mark(TIER2);
+        c.touched() = conflicts;
+        learnts_tier2.push(cr);
+        attachClause(cr);
+        probe_hbrs++; }
+    return true;
+}
 
-                //printf("beforeSize: %2d, afterSize: %2d\n", beforeSize, afterSize);
 
-                if (c.size() == 1){
-                    // when unit clause occur, enqueue and propagate
-                    uncheckedEnqueue(c[0]);
-                    if (propagate() != CRef_Undef){
-                        ok = false;
-                        return false;
-                    }
-                    // delete the clause memory in logic
-                    c.mark(1);
-                    ca.free(cr);
-//#ifdef BIN_DRUP
-//                    binDRUP('d', c, drup_file);
-//#else
-//                    fprintf(drup_file, "d ");
-//                    for (int i = 0; i < c.size(); i++)
-//                        fprintf(drup_file, "%i ", (var(c[i]) + 1) * (-2 * sign(c[i]) + 1));
-//                    fprintf(drup_file, "0\n");
-//#endif
-                }
-                else{
-                    
+// Records the unit 'u' found by 'probeTree()'.
+void Solver::probeUnit(Lit u)
+{
+    if (drup_file){
+        add_tmp.clear();
+        add_tmp.push(u);
+#ifdef BIN_DRUP
+        binDRUP('a', add_tmp, drup_file);
+#else
+        fprintf(drup_file, "%i 0\n", (var(u) + 1) * (-2 * sign(u) + 1));
+#endif
+    }
+    probe_units.push(u);
+}
 
-                    nblevels = computeLBD(c);
-                    if (nblevels < c.lbd()){
-                        //printf("lbd-before: %d, lbd-after: %d\n", c.lbd(), nblevels);
-                        c.set_lbd(nblevels);
-                    }
-                     //duplicate learnts 
-                    int id = 0;                    
-                    
-                    std::vector<uint32_t> tmp;
-                    for (int i = 0; i < c.size(); i++)                           
-                        tmp.push_back(c[i].x);
-                    id = is_duplicate(tmp);
-                     
-                                        
-                    //duplicate learnts 
-
-                    if (id < min_number_of_learnts_copies+2){
-                        attachClause(cr);
-                        learnts_tier2[cj++] = learnts_tier2[ci];                    
-                        if (id == min_number_of_learnts_copies+1){                            
-                            duplicates_added_minimization++;                                  
-                        }
-                        if ((c.lbd() <= core_lbd_cut)||(id == min_number_of_learnts_copies+1)){
-                        //if (id == min_number_of_learnts_copies+1){
-                            cj--;
-                            learnts_core.push(cr);
-                            c.mark(CORE);
-                        }
 
-                        c.setSimplified(true);
-                    }
-                }
+// Marks the literals the probe 'p' added to the trail from 'start' on as implied by 'p'. A literal
+// that the probe of '~p' implied earlier in this pass is implied either way, so it is a necessary
+// assignment; the binary clause with '~p' that is logged first makes it follow by unit propagation.
+void Solver::probeImplied(Lit p, int start)
+{
+    for (int i = start; i < trail.size(); i++){
+        Lit q = trail[i];
+        if (implied_pass[toInt(q)] == probe_pass && implied_by[toInt(q)] == ~p){
+            if (drup_file){
+                vec<Lit> ps;
+                ps.push(q);
+                ps.push(~p);
+#ifdef BIN_DRUP
+                binDRUP('a', ps, drup_file);
+#else
+                fprintf(drup_file, "%i %i 0\n", (var(q) + 1) * (-2 * sign(q) + 1), (var(p) + 1) * (2 * sign(p) - 1));
+#endif
+            }
+            probeUnit(q);
+            probe_necessary++; }
+        implied_pass[toInt(q)] = probe_pass;
+        implied_by  [toInt(q)] = p; }
+}
+
+
+// Tree-based lookahead from the root 'r': walks the binary implication graph depth first from 'r'
+// and probes the negation of every literal on the way. The negation of a literal implies the negation
+// of its parent, so its probe goes on top of the parent's and only pays for what it adds. A probe
+// that fails makes a unit of the literal, whose subtree is not entered then; so does a literal that
+// the probes of both polarities of a variable imply (see 'probeImplied()'), which takes both in the
+// same pass. The units are enqueued once the walk is done. Returns FALSE if the formula turned out
+// unsatisfiable.
+bool Solver::probeTree(Lit r, uint64_t budget)
+{
+    probe_units.clear();
+    probe_lim  .clear();
+    probe_path .clear();
+    ProbeFrame root = { r, -1 };
+    probe_path.push(root);
+    bin_stamp[toInt(r)] = bin_stamp_cur;
+
+    while (probe_path.size() > 0){
+        ProbeFrame& f = probe_path.last();
+        if (f.next < 0){
+            // Entering the literal: probe its negation. A literal that is true already fails at once.
+            Lit p = ~f.x;
+            f.next = 0;
+            probe_lim.push(trail.size());
+            bool failed = value(p) == l_False;
+            if (value(p) == l_Undef){
+                if (s_propagations >= budget){
+                    f.next = INT_MAX; continue; }
+                simpleUncheckEnqueue(p);
+                failed = simplePropagate() != CRef_Undef;
+                if (!failed) probeImplied(p, probe_lim.last()); }
+            if (failed){
+                probe_failed++;
+                probeUnit(f.x);
+                f.next = INT_MAX; }
+            continue; }
+
+        // Descend along the next edge to a literal not visited in this pass. A literal assigned
+        // but not by a probe of this pass is fixed at level 0:
+        PoolVec<Watcher>& ws = watches_bin[f.x];
+        Lit q = lit_Undef;
+        while (f.next < ws.size() && q == lit_Undef){
+            const Watcher& w = ws[f.next++];
+            if (bin_stamp[toInt(w.blocker)] == bin_stamp_cur || ca[w.cref].mark() == 1) continue;
+            if (value(w.blocker) != l_Undef && implied_pass[toInt(w.blocker)] != probe_pass) continue;
+            q = w.blocker; }
+        if (q != lit_Undef){
+            bin_stamp[toInt(q)] = bin_stamp_cur;
+            ProbeFrame g = { q, -1 };
+            probe_path.push(g);
+            continue; }
+
+        // Leaving the literal: undo its probe.
+        trailRecord = probe_lim.last();
+        probe_lim.pop();
+        cancelUntilTrailRecord();
+        probe_path.pop(); }
+
+    // A unit found early may be implied by one found later, so some may be true by now:
+    for (int i = 0; i < probe_units.size(); i++){
+        Lit u = probe_units[i];
+        if (value(u) == l_False) return false;
+        if (value(u) == l_Undef) uncheckedEnqueue(u); }
+    return propagate() == CRef_Undef;
+}
+
+
+// Probes the roots of the binary implication graph (the literals it has edges from but none to), until
+// 's_propagations' reaches 'budget'; the next call continues where this one stopped. Each root gets
+// its own probe, for the hyper-binary resolvents, then the lookahead of 'probeTree()'. Must be called
+// at decision level 0 with everything propagated. Returns FALSE if the formula turned out
+// unsatisfiable.
+bool Solver::probe(uint64_t budget)
+{
+    assert(decisionLevel() == 0 && qhead == trail.size());
+    probe_parent.growTo(nVars(), lit_Undef);
+    probe_depth .growTo(nVars(), 0);
+    implied_pass.growTo(2 * nVars(), 0);
+    implied_by  .growTo(2 * nVars(), lit_Undef);
+    watches_bin.cleanAll();
+    // 'probeRoot()' tells the literals of a probe by 'seen[]', which 'simpleAnalyze()' may leave set:
+    for (int v = 0; v < nVars(); v++) seen[v] = 0;
+    if (++probe_pass == 0){
+        for (int i = 0; i < implied_pass.size(); i++) implied_pass[i] = 0;
+        probe_pass = 1; }
+    nextBinStamp();
+
+    for (int n = 0; n < 2 * nVars() && s_propagations < budget; n++){
+        Lit p = toLit(probe_next);
+        probe_next = (probe_next + 1) % (2 * nVars());
+        if (value(p) != l_Undef || !decision[var(p)]) continue;
+        if (watches_bin[p].size() == 0 || watches_bin[~p].size() > 0) continue;
+        if (!probeRoot(p)) return false;
+        if (value(p) == l_Undef && bin_stamp[toInt(p)] != bin_stamp_cur && !probeTree(p, budget)) return false; }
+
+    exportNewClauses();
+    return true;
+}
+
+
+// Forward subsumption and self-subsuming resolution of the core and tier2 tiers, against each other
+// and the original clauses. Every clause is watched by one of its literals only, the one with the
+// fewest occurrences, so a clause that subsumes 'c' is watched by a literal of 'c', and one that
+// strengthens it by a literal of 'c' or its negation. A learnt clause that subsumes one of the core
+// tier moves there itself. Checks learnt clauses until 'subsume_ticks' reaches 'budget'; the next
+// call continues where this one stopped. Must be called at decision level 0 with everything
+// propagated. Returns FALSE if the formula turned out unsatisfiable.
+bool Solver::subsumeLearnts(uint64_t budget)
+{
+    assert(decisionLevel() == 0 && qhead == trail.size());
+
+    vec<CRef> cs;
+    uint64_t  build = nVars();
+    for (int i = 0; i < clauses.size(); i++)
+        if (!removed(clauses[i])){
+            cs.push(clauses[i]);
+            build += ca[clauses[i]].size(); }
+    int n_orig = cs.size();
+    for (int i = 0; i < learnts_core.size(); i++)
+        if (ca[learnts_core[i]].mark() == CORE){
+            cs.push(learnts_core[i]);
+            build += ca[learnts_core[i]].size(); }
+    for (int i = 0; i < learnts_tier2.size(); i++)
+        if (ca[learnts_tier2[i]].mark() == TIER2){
+            cs.push(learnts_tier2[i]);
+            build += ca[learnts_tier2[i]].size(); }
+    int n_learnts = cs.size() - n_orig;
+    if (n_learnts == 0) return true;
+
+    // Setting up the occurrences is work of the pass. A call whose budget does not even cover it
+    // saves the budget up for a later one:
+    budget       += subsume_saved;
+    subsume_saved = 0;
+    if (subsume_ticks + build >= budget){
+        subsume_saved = budget - subsume_ticks;
+        return true; }
+    subsume_ticks += build;
+    subsume_passes++;
+
+    // Watch each clause by its literal with the fewest occurrences. Learnt clauses have no room for
+    // an abstraction, and the stored one of an original is stale wherever it was rewritten in place,
+    // so they are all computed here:
+    vec<uint32_t> abst(cs.size());
+    vec<int>      n_occ(2 * nVars(), 0);
+    for (int i = 0; i < cs.size(); i++){
+        const Clause& c = ca[cs[i]];
+        abst[i] = c.abstractLits();
+        for (int k = 0; k < c.size(); k++) n_occ[toInt(c[k])]++; }
+    subsume_occs.growTo(2 * nVars());
+    for (int i = 0; i < cs.size(); i++){
+        const Clause& c = ca[cs[i]];
+        Lit best = c[0];
+        for (int k = 1; k < c.size(); k++)
+            if (n_occ[toInt(c[k])] < n_occ[toInt(best)]) best = c[k];
+        subsume_occs[toInt(best)].push(i); }
+
+    for (int n = 0; n < n_learnts && subsume_ticks < budget; n++){
+        subsume_next = subsume_next % n_learnts;
+        int     i  = n_orig + subsume_next++;
+        CRef    cr = cs[i];
+        Clause& c  = ca[cr];
+        if (c.mark() == 1) continue;
+
+        bool assigned = false;
+        for (int k = 0; k < c.size() && !assigned; k++)
+            assigned = value(c[k]) != l_Undef;
+        if (assigned) continue;
+
+        CRef by = CRef_Undef;
+        Lit  l  = lit_Error;
+        for (int k = 0; k < 2 * c.size() && l != lit_Undef; k++){
+            vec<int>& ws = subsume_occs[toInt(c[k >> 1] ^ (k & 1))];
+            subsume_ticks += 1 + ws.size();
+            for (int j = 0; j < ws.size(); j++){
+                if (ws[j] == i || removed(cs[ws[j]])) continue;
+                Lit r = ca[cs[ws[j]]].subsumes(c, abst[ws[j]], abst[i]);
+                if (r == lit_Undef || (r != lit_Error && l == lit_Error)){
+                    by = cs[ws[j]];
+                    l  = r;
+                    if (r == lit_Undef) break; }
             }
         }
+
+        if (l == lit_Undef){
+            Clause& d = ca[by];
+            if (d.learnt()){
+                if (c.mark() == CORE && d.mark() == TIER2){
+                    learnts_core.push(by);
+                    d.mark(CORE); }
+                if (d.lbd() > c.lbd()) d.set_lbd(c.lbd());
+                if (d.touched() < c.touched()) d.touched() = c.touched(); }
+            removeClause(cr);
+            subsumed_learnts++;
+        }else if (l != lit_Error){
+            detachClause(cr, true);
+            c.strengthen(~l);
+            abst[i] = c.abstractLits();
+            if (c.lbd() > c.size()) c.set_lbd(c.size());
+            strengthened_learnts++;
+
+            if (drup_file){
+                add_tmp.clear();
+                for (int k = 0; k < c.size(); k++) add_tmp.push(c[k]);
+                add_tmp.push(~l);
+#ifdef BIN_DRUP
+                binDRUP('a', c, drup_file);
+                binDRUP('d', add_tmp, drup_file);
+#else
+                for (int k = 0; k < c.size(); k++)
+                    fprintf(drup_file, "%i ", (var(c[k]) + 1) * (-2 * sign(c[k]) + 1));
+                fprintf(drup_file, "0\nd ");
+                for (int k = 0; k < add_tmp.size(); k++)
+                    fprintf(drup_file, "%i ", (var(add_tmp[k]) + 1) * (-2 * sign(add_tmp[k]) + 1));
+                fprintf(drup_file, "0\n");
+#endif
+            }
+
+            if (c.size() == 1){
+                uncheckedEnqueue(c[0]);
+                c.mark(1);
+                ca.free(cr);
+                if (propagate() != CRef_Undef) return false;
+            }else
+                attachClause(cr);
+        }
     }
-    learnts_tier2.shrink(ci - cj);
 
-    //    printf("c nbLearnts_tier2 %d / %d, nbSimplified: %d, nbSimplifing: %d\n",
-    //           learnts_tier2_size_before, learnts_tier2.size(), nbSimplified, nbSimplifing);
+    for (int i = 0; i < subsume_occs.size(); i++)
+        subsume_occs[i].clear();
+    cleanTiers();
 
+    exportNewClauses();
     return true;
+}
+
+
+// Candidates of 'buildXors()': the literals of a clause sorted by variable, and their signs as bits.
+struct XorCand { int start, size; unsigned signs; };
+struct XorCandLt {
+    const vec<Lit>& lits;
+    XorCandLt(const vec<Lit>& l) : lits(l) {}
+    bool operator () (const XorCand& x, const XorCand& y) const {
+        if (x.size != y.size) return x.size < y.size;
+        for (int k = 0; k < x.size; k++)
+            if (var(lits[x.start + k]) != var(lits[y.start + k]))
+                return var(lits[x.start + k]) < var(lits[y.start + k]);
+        return false; }
+};
 
+static Var xorRoot(vec<Var>& parent, Var v)
+{
+    while (parent[v] != v) v = parent[v] = parent[parent[v]];
+    return v;
 }
 
-bool Solver::simplifyAll()
+// Finds the XOR constraints among the problem clauses and sets up a matrix for each group of them
+// that share variables. An XOR constraint of 'k' variables is encoded by the '2^(k-1)' clauses that
+// exclude the assignments of the wrong parity; the sign pattern of a clause is the assignment it
+// excludes. Clauses with assigned literals take no part, so the matrices start out with all their
+// columns unassigned. Matrices of too many variables are left to the clauses. With a proof to
+// write, no matrix is set up at all: the reasons made from rows combining several constraints do
+// not follow by unit propagation. Must be called at decision level 0. Returns FALSE if the formula
+// turned out unsatisfiable.
+bool Solver::buildXors()
 {
-    ////
-    simplified_length_record = original_length_record = 0;
+    assert(decisionLevel() == 0);
+    xor_stale = false;
+    for (int i = 0; i < xor_matrices.size(); i++)
+        delete xor_matrices[i];
+    xor_matrices.clear();
+    for (int v = 0; v < nVars(); v++)
+        xor_mat[v] = -1;
+    xor_snaps.clear();
+    xor_qhead  = trail.size();
+    xors_found = xor_rows = 0;
+    if (!use_xor || drup_file) return true;
+
+    vec<Lit>     lits;
+    vec<XorCand> cands;
+    for (int i = 0; i < clauses.size(); i++){
+        const Clause& c = ca[clauses[i]];
+        if (c.mark() != 0 || c.size() < 3 || c.size() > xor_max_size) continue;
+        int k;
+        for (k = 0; k < c.size() && value(c[k]) == l_Undef; k++);
+        if (k < c.size()) continue;
+        XorCand cand = { lits.size(), c.size(), 0 };
+        for (k = 0; k < c.size(); k++)
+            lits.push(c[k]);
+        sort(&lits[cand.start], cand.size);
+        for (k = 0; k < c.size(); k++)
+            cand.signs |= (unsigned)sign(lits[cand.start + k]) << k;
+        cands.push(cand); }
+    XorCandLt lt(lits);
+    sort(cands, lt);
+
+    vec<Var>  xvars;                    // The variables of the constraints found, one after the other,
+    vec<int>  xsizes;                   // how many each has,
+    vec<char> xrhs;                     // and what they sum up to.
+    for (int i = 0, j; i < cands.size(); i = j){
+        int      k    = cands[i].size;
+        uint64_t pats = 0;
+        for (j = i; j < cands.size() && !lt(cands[i], cands[j]); j++)
+            pats |= (uint64_t)1 << cands[j].signs;
+        if (j - i < 1 << (k - 1)) continue;
+
+        uint64_t even = 0, all = k == 6 ? ~(uint64_t)0 : ((uint64_t)1 << (1 << k)) - 1;
+        for (unsigned s = 0; s < 1u << k; s++)
+            if ((__builtin_popcount(s) & 1) == 0) even |= (uint64_t)1 << s;
+        for (int par = 0; par < 2; par++){
+            uint64_t need = par == 0 ? even : all & ~even;
+            if ((pats & need) != need) continue;
+            for (int t = 0; t < k; t++)
+                xvars.push(var(lits[cands[i].start + t]));
+            xsizes.push(k);
+            xrhs.push(!par); } }
+    xors_found = xsizes.size();
+    if (xors_found == 0) return true;
+
+    // Group the constraints by the variables they share:
+    vec<Var> parent(nVars());
+    vec<int> rows(nVars(), 0), cols(nVars(), 0);
+    for (int v = 0; v < nVars(); v++)
+        parent[v] = v;
+    for (int i = 0, start = 0; i < xsizes.size(); start += xsizes[i++])
+        for (int t = 1; t < xsizes[i]; t++)
+            parent[xorRoot(parent, xvars[start + t])] = xorRoot(parent, xvars[start]);
+    for (int i = 0, start = 0; i < xsizes.size(); start += xsizes[i++])
+        rows[xorRoot(parent, xvars[start])]++;
+    for (int i = 0; i < xvars.size(); i++)
+        if (!seen[xvars[i]]){
+            seen[xvars[i]] = 1;
+            cols[xorRoot(parent, xvars[i])]++; }
+
+    vec<int>        group(nVars(), -1);     // Per root: its matrix.
+    vec<vec<Var> >  columns;
+    for (int v = 0; v < nVars(); v++){
+        if (!seen[v]) continue;
+        seen[v] = 0;
+        Var r = xorRoot(parent, v);
+        if (rows[r] < 2 || cols[r] > xor_max_vars) continue;
+        if (group[r] < 0){
+            group[r] = columns.size();
+            columns.push(); }
+        xor_mat[v] = group[r];
+        xor_col[v] = columns[group[r]].size();
+        columns[group[r]].push(v); }
+    for (int m = 0; m < columns.size(); m++)
+        xor_matrices.push(new XorMatrix(*this, columns[m]));
+
+    vec<int> cs;
+    for (int i = 0, start = 0; i < xsizes.size(); start += xsizes[i++]){
+        int m = xor_mat[xvars[start]];
+        if (m < 0) continue;
+        cs.clear();
+        for (int t = 0; t < xsizes[i]; t++)
+            cs.push(xor_col[xvars[start + t]]);
+        xor_matrices[m]->addRow(cs, xrhs[i]); }
+    for (int m = 0; m < xor_matrices.size(); m++){
+        if (!xor_matrices[m]->init())
+            return ok = false;
+        xor_rows += xor_matrices[m]->nRows(); }
+    return true;
+}
 
-    if (!ok || propagate() != CRef_Undef)
-        return ok = false;
 
-    //// cleanLearnts(also can delete these code), here just for analyzing
-    //if (local_learnts_dirty) cleanLearnts(learnts_local, LOCAL);
-    //if (tier2_learnts_dirty) cleanLearnts(learnts_tier2, TIER2);
-    //local_learnts_dirty = tier2_learnts_dirty = false;
+// Lets the matrices see the assignments on the trail. Returns a conflicting clause, if any.
+CRef Solver::xorPropagate()
+{
+    while (xor_qhead < trail.size()){
+        Var v = var(trail[xor_qhead++]);
+        if (xor_mat[v] < 0) continue;
+        CRef confl = xor_matrices[xor_mat[v]]->assign(xor_col[v]);
+        if (confl != CRef_Undef){
+            xor_qhead = trail.size();
+            return confl; } }
+    return CRef_Undef;
+}
 
-    if (!simplifyLearnt_core()) return ok = false;
-    if (!simplifyLearnt_tier2()) return ok = false;
-    //if (!simplifyLearnt_x(learnts_local)) return ok = false;
 
-    checkGarbage();
+// Enqueues what a matrix implied, keeping a copy of the row for 'xorReason()'.
+void Solver::xorEnqueue(Lit p, int level, const uint64_t* row, int words)
+{
+    xor_snap[var(p)] = xor_snaps.size();
+    for (int k = 0; k < words; k++)
+        xor_snaps.push(row[k]);
+    uncheckedEnqueue(p, level, CRef_Xor);
+    xor_props++;
+}
 
-    ////
-    //  printf("c size_reduce_ratio     : %4.2f%%\n",
-    //         original_length_record == 0 ? 0 : (original_length_record - simplified_length_record) * 100 / (double)original_length_record);
 
-    return true;
+// Allocates the temporary clause of 'xor_lits'. These die on the next backtrack, so they go in the
+// learnt region, which is compacted on every collection, rather than leave holes in the original
+// one. Their LBD stays 0, which no computed LBD improves on, so 'analyze()' never moves them into
+// a tier.
+CRef Solver::xorAlloc()
+{
+    return ca.alloc(xor_lits, true);
 }
+
+
+// A clause of the literals of a conflicting row. The two of the highest levels go first, as
+// 'FindConflictLevel()' expects of a clause that is not watched.
+CRef Solver::xorConflict(const XorMatrix& m, const uint64_t* row)
+{
+    m.explain(row, xor_lits);
+    for (int k = 0; k < 2 && k < xor_lits.size(); k++){
+        int max_i = k;
+        for (int i = k + 1; i < xor_lits.size(); i++)
+            if (level(var(xor_lits[i])) > level(var(xor_lits[max_i])))
+                max_i = i;
+        std::swap(xor_lits[k], xor_lits[max_i]); }
+    CRef cr = xorAlloc();
+    xor_temp.push(cr);
+    xor_conflicts++;
+    return cr;
+}
+
+
+// Makes the reason of 'x' from the copy of the row that implied it, with 'x' first.
+CRef Solver::xorReason(Var x)
+{
+    xor_matrices[xor_mat[x]]->explain(&xor_snaps[xor_snap[x]], xor_lits);
+    for (int i = 0; i < xor_lits.size(); i++)
+        if (var(xor_lits[i]) == x){
+            xor_lits[i] = xor_lits[0];
+            xor_lits[0] = mkLit(x, value(x) == l_False);
+            break; }
+    CRef cr = xorAlloc();
+    vardata[x].reason = cr;
+    xor_temp.push(cr);
+    xor_reasons++;
+    return cr;
+}
+
 //=================================================================================================
 // Minor methods:
 
@@ -929,17 +1898,22 @@ Var Solver::newVar(bool sign, bool dvar)
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
     assigns  .push(l_Undef);
+    lit_assigns.push(l_Undef);
+    lit_assigns.push(l_Undef);
+    lit_assigns.capacity(lit_assigns.size() + 3); // Slack for the 4-byte gathers of 'findWatchWide()'.
     vardata  .push(mkVarData(CRef_Undef, 0));
     activity_CHB  .push(0);
     activity_VSIDS.push(rnd_init_act ? drand(random_seed) * 0.00001 : 0);
     activity_distance.push(0);
+    VmtfLink link = { var_Undef, var_Undef, 0 };
+    vmtf_links.push(link);
+    vmtfEnqueue(v);
 
-    picked.push(0);
-    conflicted.push(0);
-    almost_conflicted.push(0);
-#ifdef ANTI_EXPLORATION
-    canceled.push(0);
-#endif
+    lrb.push();                 // (value-initialized, so all zero)
+    subst.push(lit_Undef);
+    xor_mat .push(-1);
+    xor_col .push(0);
+    xor_snap.push(0);
 
     seen     .push(0);
     seen2    .push(0);
@@ -960,6 +1934,9 @@ bool Solver::addClause_(vec<Lit>& ps)
     assert(decisionLevel() == 0);
     if (!ok) return false;
 
+    if (substituted > 0 && !substitute(ps))
+        return true;
+
     // Check if clause is satisfied and remove false/duplicate literals:
     sort(ps);
     Lit p; int i, j;
@@ -1010,7 +1987,7 @@ void Solver::attachClause(CRef cr) {
     redis->learnts.push(cr);
     const Clause& c = ca[cr];
     assert(c.size() > 1);
-    OccLists<Lit, vec<Watcher>, WatcherDeleted>& ws = c.size() == 2 ? watches_bin : watches;
+    PooledOccLists<Lit, Watcher, WatcherDeleted>& ws = c.size() == 2 ? watches_bin : watches;
     ws[~c[0]].push(Watcher(cr, c[1]));
     ws[~c[1]].push(Watcher(cr, c[0]));
     if (c.learnt()) learnts_literals += c.size();
@@ -1020,7 +1997,7 @@ void Solver::attachClause(CRef cr) {
 void Solver::detachClause(CRef cr, bool strict) {
     const Clause& c = ca[cr];
     assert(c.size() > 1);
-    OccLists<Lit, vec<Watcher>, WatcherDeleted>& ws = c.size() == 2 ? watches_bin : watches;
+    PooledOccLists<Lit, Watcher, WatcherDeleted>& ws = c.size() == 2 ? watches_bin : watches;
     
     if (strict){
         remove(ws[~c[0]], Watcher(cr, c[1]));
@@ -1037,6 +2014,8 @@ void Solver::detachClause(CRef cr, bool strict) {
 
 void Solver::removeClause(CRef cr) {
     Clause& c = ca[cr];
+    clause_deletions++;
+    if (!c.learnt()) original_changes++;
 
     if (drup_file){
         if (c.mark() != 1){
@@ -1078,20 +2057,23 @@ void Solver::cancelUntil(int bLevel) {
 		std::cout << "bt " << bLevel << "\n";
 #endif				
 		add_tmp.clear();
+        int xor_cut = xor_snaps.size();
         for (int c = trail.size()-1; c >= trail_lim[bLevel]; c--)
         {
             Var      x  = var(trail[c]);
 
 			if (level(x) <= bLevel)
 			{
+                if (reason(x) == CRef_Xor)
+                    xorReason(x);           // (its row goes with the others above 'xor_cut')
 				add_tmp.push(trail[c]);
 			}
 			else
 			{
 				 if (!VSIDS){
-					uint32_t age = conflicts - picked[x];
+					uint32_t age = conflicts - lrb[x].picked;
 					if (age > 0){
-						double adjusted_reward = ((double) (conflicted[x] + almost_conflicted[x])) / ((double) age);
+						double adjusted_reward = ((double) (lrb[x].conflicted + lrb[x].almost_conflicted)) / ((double) age);
 						double old_activity = activity_CHB[x];
 						activity_CHB[x] = step_size * adjusted_reward + ((1 - step_size) * old_activity);
 						if (order_heap_CHB.inHeap(x)){
@@ -1102,11 +2084,16 @@ void Solver::cancelUntil(int bLevel) {
 						}
 					}
 #ifdef ANTI_EXPLORATION
-					canceled[x] = conflicts;
+					lrb[x].canceled = conflicts;
 #endif
 				}
 				
 				assigns [x] = l_Undef;
+				lit_assigns[toInt(trail[c])] = lit_assigns[toInt(~trail[c])] = l_Undef;
+                if (xor_mat[x] >= 0){
+                    xor_matrices[xor_mat[x]]->unassign(xor_col[x]);
+                    if (reason(x) == CRef_Xor && xor_snap[x] < xor_cut)
+                        xor_cut = xor_snap[x]; }
 #ifdef PRINT_OUT
 				std::cout << "undo " << x << "\n";
 #endif				
@@ -1116,6 +2103,16 @@ void Solver::cancelUntil(int bLevel) {
 			}
         }
         qhead = trail_lim[bLevel];
+        if (xor_qhead > qhead) xor_qhead = qhead;
+        xor_snaps.shrink(xor_snaps.size() - xor_cut);
+        if (xor_temp.size() > 0){
+            int i, j;
+            for (i = j = 0; i < xor_temp.size(); i++)
+                if (value(ca[xor_temp[i]][0]) == l_Undef)
+                    ca.free(xor_temp[i]);
+                else
+                    xor_temp[j++] = xor_temp[i];
+            xor_temp.shrink(i - j); }
         trail.shrink(trail.size() - trail_lim[bLevel]);
         trail_lim.shrink(trail_lim.size() - bLevel);
         for (int nLitId = add_tmp.size() - 1; nLitId >= 0; --nLitId)
@@ -1131,11 +2128,29 @@ void Solver::cancelUntil(int bLevel) {
 // Major methods:
 
 
+#ifdef ANTI_EXPLORATION
+static const AntiExplorationDecay anti_exploration_decay;
+
+void Solver::decayActivityCHB(Var v)
+{
+    uint32_t age = conflicts - lrb[v].canceled;
+    if (age > 0){
+        activity_CHB[v] *= anti_exploration_decay(age);
+        if (order_heap_CHB.inHeap(v))
+            order_heap_CHB.increase(v);
+    }
+}
+#endif
+
+
 Lit Solver::pickBranchLit()
 {
     Var next = var_Undef;
-    //    Heap<VarOrderLt>& order_heap = VSIDS ? order_heap_VSIDS : order_heap_CHB;
-    Heap<VarOrderLt>& order_heap = DISTANCE ? order_heap_distance : ((!VSIDS)? order_heap_CHB:order_heap_VSIDS);
+    if (vmtfActive()){
+        next = vmtfPick();
+        return next == var_Undef ? lit_Undef : mkLit(next, polarity[next]); }
+
+    Heap<VarOrderLt>& order_heap = orderHeap();
 
     // Random decision:
     /*if (drand(random_seed) < random_var_freq && !order_heap.empty()){
@@ -1149,17 +2164,12 @@ Lit Solver::pickBranchLit()
             return lit_Undef;
         else{
 #ifdef ANTI_EXPLORATION
-            if (!VSIDS){
+            if (&order_heap == &order_heap_CHB){
                 Var v = order_heap_CHB[0];
-                uint32_t age = conflicts - canceled[v];
-                while (age > 0){
-                    double decay = pow(0.95, age);
-                    activity_CHB[v] *= decay;
-                    if (order_heap_CHB.inHeap(v))
-                        order_heap_CHB.increase(v);
-                    canceled[v] = conflicts;
+                while (lrb[v].canceled != conflicts){
+                    decayActivityCHB(v);
+                    lrb[v].canceled = conflicts;
                     v = order_heap_CHB[0];
-                    age = conflicts - canceled[v];
                 }
             }
 #endif
@@ -1202,7 +2212,7 @@ inline Solver::ConflictData Solver::FindConflictLevel(CRef cind)
 		std::swap(conflCls[0], conflCls[highestId]);
 		if (highestId > 1)
 		{
-			OccLists<Lit, vec<Watcher>, WatcherDeleted>& ws = conflCls.size() == 2 ? watches_bin : watches;
+			PooledOccLists<Lit, Watcher, WatcherDeleted>& ws = conflCls.size() == 2 ? watches_bin : watches;
 			//ws.smudge(~conflCls[highestId]);
 			remove(ws[~conflCls[highestId]], Watcher(cind, conflCls[1]));
 			ws[~conflCls[0]].push(Watcher(cind, conflCls[1]));
@@ -1230,7 +2240,7 @@ inline Solver::ConflictData Solver::FindConflictLevel(CRef cind)
 |        rest of literals. There may be others from the same level though.
 |  
 |________________________________________________________________________________________________@*/
-void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd)
+void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd, uint64_t& out_fp)
 {
     int pathC = 0;
     Lit p     = lit_Undef;
@@ -1279,15 +2289,16 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
 
             if (!seen[var(q)] && level(var(q)) > 0){
                 if (VSIDS){
-                    varBumpActivity(var(q), .5);
+                    if (!VMTF) varBumpActivity(var(q), .5);
                     add_tmp.push(q);
                 }else
-                    conflicted[var(q)]++;
+                    lrb[var(q)].conflicted++;
                 seen[var(q)] = 1;
                 if (level(var(q)) >= nDecisionLevel){
                     pathC++;
-                }else
+                }else{
                     out_learnt.push(q);
+                    out_fp += litHash(q); }
             }
         }
         
@@ -1297,12 +2308,13 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
 			p  = trail[index+1];
 		} while (level(var(p)) < nDecisionLevel);
 		
-        confl = reason(var(p));
+        confl = reasonClause(var(p));
         seen[var(p)] = 0;
         pathC--;
 
     }while (pathC > 0);
     out_learnt[0] = ~p;
+    out_fp += litHash(~p);
 
     // Simplify conflict clause:
     //
@@ -1316,7 +2328,9 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
         for (i = j = 1; i < out_learnt.size(); i++)
             if (reason(var(out_learnt[i])) == CRef_Undef || !litRedundant(out_learnt[i], abstract_level))
                 out_learnt[j++] = out_learnt[i];
-        
+            else
+                out_fp -= litHash(out_learnt[i]);
+
     }else if (ccmin_mode == 1){
         for (i = j = 1; i < out_learnt.size(); i++){
             Var x = var(out_learnt[i]);
@@ -1324,11 +2338,14 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
             if (reason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = ca[reason(var(out_learnt[i]))];
-                for (int k = c.size() == 2 ? 0 : 1; k < c.size(); k++)
+                Clause& c = ca[reasonClause(var(out_learnt[i]))];
+                int k;
+                for (k = c.size() == 2 ? 0 : 1; k < c.size(); k++)
                     if (!seen[var(c[k])] && level(var(c[k])) > 0){
                         out_learnt[j++] = out_learnt[i];
                         break; }
+                if (k == c.size())
+                    out_fp -= litHash(out_learnt[i]);
             }
         }
     }else
@@ -1340,7 +2357,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
 
     out_lbd = computeLBD(out_learnt);
     if (out_lbd <= 6 && out_learnt.size() <= 30) // Try further minimization?
-        if (binResMinimize(out_learnt))
+        if (binResMinimize(out_learnt, out_fp))
             out_lbd = computeLBD(out_learnt); // Recompute LBD if minimized.
 
     // Find correct backtrack level:
@@ -1360,7 +2377,10 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
         out_btlevel       = level(var(p));
     }
 
-    if (VSIDS){
+    if (VSIDS && VMTF){
+        vmtfBump(add_tmp);
+        add_tmp.clear();
+    }else if (VSIDS){
         for (int i = 0; i < add_tmp.size(); i++){
             Var v = var(add_tmp[i]);
             if (level(v) >= out_btlevel - 1)
@@ -1371,14 +2391,14 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
         seen[var(p)] = true;
         for(int i = out_learnt.size() - 1; i >= 0; i--){
             Var v = var(out_learnt[i]);
-            CRef rea = reason(v);
+            CRef rea = reasonClause(v);
             if (rea != CRef_Undef){
                 const Clause& reaC = ca[rea];
                 for (int i = 0; i < reaC.size(); i++){
                     Lit l = reaC[i];
                     if (!seen[var(l)]){
                         seen[var(l)] = true;
-                        almost_conflicted[var(l)]++;
+                        lrb[var(l)].almost_conflicted++;
                         analyze_toclear.push(l); } } } } }
 
     for (int j = 0; j < analyze_toclear.size(); j++) seen[var(analyze_toclear[j])] = 0;    // ('seen[]' is now cleared)
@@ -1386,7 +2406,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& ou
 
 
 // Try further learnt clause minimization by means of binary clause resolution.
-bool Solver::binResMinimize(vec<Lit>& out_learnt)
+bool Solver::binResMinimize(vec<Lit>& out_learnt, uint64_t& fp)
 {
     // Preparation: remember which false variables we have in 'out_learnt'.
     counter++;
@@ -1394,7 +2414,7 @@ bool Solver::binResMinimize(vec<Lit>& out_learnt)
         seen2[var(out_learnt[i])] = counter;
 
     // Get the list of binary clauses containing 'out_learnt[0]'.
-    const vec<Watcher>& ws = watches_bin[~out_learnt[0]];
+    const PoolVec<Watcher>& ws = watches_bin[~out_learnt[0]];
 
     int to_remove = 0;
     for (int i = 0; i < ws.size(); i++){
@@ -1403,6 +2423,7 @@ bool Solver::binResMinimize(vec<Lit>& out_learnt)
         if (seen2[var(the_other)] == counter && value(the_other) == l_True){
             to_remove++;
             seen2[var(the_other)] = counter - 1; // Remember to remove this variable.
+            fp -= litHash(~the_other);
         }
     }
 
@@ -1426,7 +2447,7 @@ bool Solver::litRedundant(Lit p, uint32_t abstract_levels)
     int top = analyze_toclear.size();
     while (analyze_stack.size() > 0){
         assert(reason(var(analyze_stack.last())) != CRef_Undef);
-        Clause& c = ca[reason(var(analyze_stack.last()))]; analyze_stack.pop();
+        Clause& c = ca[reasonClause(var(analyze_stack.last()))]; analyze_stack.pop();
 
         // Special handling for binary clauses like in 'analyze()'.
         if (c.size() == 2 && value(c[0]) == l_False){
@@ -1481,7 +2502,7 @@ void Solver::analyzeFinal(Lit p, vec<Lit>& out_conflict)
                 assert(level(x) > 0);
                 out_conflict.push(~trail[i]);
             }else{
-                Clause& c = ca[reason(x)];
+                Clause& c = ca[reasonClause(x)];
                 for (int j = c.size() == 2 ? 0 : 1; j < c.size(); j++)
                     if (level(var(c[j])) > 0)
                         seen[var(c[j])] = 1;
@@ -1505,21 +2526,17 @@ void Solver::uncheckedEnqueue(Lit p, int level, CRef from)
 
     Var x = var(p);
     if (!VSIDS){
-        picked[x] = conflicts;
-        conflicted[x] = 0;
-        almost_conflicted[x] = 0;
+        lrb[x].picked = conflicts;
+        lrb[x].conflicted = 0;
+        lrb[x].almost_conflicted = 0;
 #ifdef ANTI_EXPLORATION
-        uint32_t age = conflicts - canceled[var(p)];
-        if (age > 0){
-            double decay = pow(0.95, age);
-            activity_CHB[var(p)] *= decay;
-            if (order_heap_CHB.inHeap(var(p)))
-                order_heap_CHB.increase(var(p));
-        }
+        decayActivityCHB(x);
 #endif
     }
 
     assigns[x] = lbool(!sign(p));
+    lit_assigns[toInt(p)] = l_True;
+    lit_assigns[toInt(~p)] = l_False;
     vardata[x] = mkVarData(from, level);
     trail.push_(p);
 }
@@ -1543,14 +2560,15 @@ CRef Solver::propagate()
     watches.cleanAll();
     watches_bin.cleanAll();
 
+Propagate:
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
         int currLevel = level(var(p));
-        vec<Watcher>&  ws  = watches[p];
+        PoolVec<Watcher>&  ws  = watches[p];
         Watcher        *i, *j, *end;
         num_props++;
 
-        vec<Watcher>& ws_bin = watches_bin[p];  // Propagate binary clauses first.
+        PoolVec<Watcher>& ws_bin = watches_bin[p];  // Propagate binary clauses first.
         for (int k = 0; k < ws_bin.size(); k++){
             Lit the_other = ws_bin[k].blocker;
             if (value(the_other) == l_False){
@@ -1591,11 +2609,15 @@ CRef Solver::propagate()
                 *j++ = w; continue; }
 
             // Look for new watch:
-            for (int k = 2; k < c.size(); k++)
-                if (value(c[k]) != l_False){
-                    c[1] = c[k]; c[k] = false_lit;
-                    watches[~c[1]].push(w);
-                    goto NextClause; }
+            int k = 2;
+            if (simd_watch_min > 0 && c.size() >= simd_watch_min)
+                k = findWatchWide(&c[0], 2, c.size(), lit_assigns);
+            else
+                while (k < c.size() && value(c[k]) == l_False) k++;
+            if (k < c.size()){
+                c[1] = c[k]; c[k] = false_lit;
+                watches[~c[1]].push(w);
+                goto NextClause; }
 
             // Did not find watch -- clause is unit under assignment:
             *j++ = w;
@@ -1648,6 +2670,12 @@ NextClause:;
         ws.shrink(i - j);
     }
 
+    // The XOR matrices go once the clauses are done, and the clauses again on what they implied:
+    if (confl == CRef_Undef && xor_matrices.size() > 0 && !xor_stale){
+        confl = xorPropagate();
+        if (confl == CRef_Undef && qhead < trail.size())
+            goto Propagate; }
+
 ExitProp:;
     propagations += num_props;
     simpDB_props -= num_props;
@@ -1745,14 +2773,63 @@ void Solver::safeRemoveSatisfied(vec<CRef>& cs, unsigned valid_mark)
 
 void Solver::rebuildOrderHeap()
 {
+    if (order_heap_active == NULL) return;  // (VMTF needs no rebuilding)
+
     vec<Var> vs;
     for (Var v = 0; v < nVars(); v++)
         if (decision[v] && value(v) == l_Undef)
             vs.push(v);
 
-    order_heap_CHB  .build(vs);
-    order_heap_VSIDS.build(vs);
-    order_heap_distance.build(vs);
+    order_heap_active->build(vs);
+}
+
+
+void Solver::vmtfEnqueue(Var v)
+{
+    VmtfLink& l = vmtf_links[v];
+    if (vmtf_last == v) return;
+    if (l.prev != var_Undef || vmtf_first == v){
+        // Unlink:
+        if (l.prev != var_Undef) vmtf_links[l.prev].next = l.next;
+        else                     vmtf_first = l.next;
+        vmtf_links[l.next].prev = l.prev; }
+
+    l.prev = vmtf_last;
+    l.next = var_Undef;
+    if (vmtf_last != var_Undef) vmtf_links[vmtf_last].next = v;
+    else                        vmtf_first = v;
+    vmtf_last = v;
+    l.stamp   = ++vmtf_stamp;
+}
+
+
+void Solver::vmtfBump(vec<Lit>& lits)
+{
+    sort(lits, VmtfStampLt(vmtf_links));
+    for (int i = 0; i < lits.size(); i++)
+        vmtfEnqueue(var(lits[i]));
+    // The last one is the new end of the queue:
+    if (lits.size() > 0 && value(var(lits.last())) == l_Undef)
+        vmtf_cursor = var(lits.last());
+}
+
+
+Var Solver::vmtfPick()
+{
+    Var v = vmtf_cursor;
+    while (v != var_Undef && (value(v) != l_Undef || !decision[v]))
+        v = vmtf_links[v].prev;
+    vmtf_cursor = v;
+    return v;
+}
+
+
+void Solver::activateOrderHeap(Heap<VarOrderLt>& h)
+{
+    if (order_heap_active != NULL)
+        order_heap_active->clear(true);
+    order_heap_active = &h;
+    rebuildOrderHeap();
 }
 
 
@@ -1822,7 +2899,7 @@ bool Solver::collectFirstUIP(CRef confl){
             //      	varBumpActivity(v);
             seen[v]=0;
             if (--pathCs[currentDecLevel]!=0) {
-                Clause& rc=ca[reason(v)];
+                Clause& rc=ca[reasonClause(v)];
                 int reasonVarLevel=var_iLevel_tmp[v]+1;
                 if(reasonVarLevel>max_level) max_level=reasonVarLevel;
                 if (rc.size()==2 && value(rc[0])==l_False) {
@@ -1928,9 +3005,14 @@ lbool Solver::search(int& nof_conflicts)
     int         backtrack_level;
     int         lbd;
     vec<Lit>    learnt_clause;
+    uint64_t    learnt_fp;
     bool        cached = false;
     starts++;
 
+    // Take over the clauses vivified by the helper thread since the last restart:
+    if (vivifier != NULL && vivifier->done() && !applyVivified())
+        return l_False;
+
     // simplify
     //
     if (conflicts >= curSimplify * nbconfbeforesimplify){
@@ -1955,6 +3037,11 @@ lbool Solver::search(int& nof_conflicts)
         nbconfbeforesimplify += incSimplify;
     }
 
+    if (!inprocess())
+        return l_False;
+    if (xor_stale && !buildXors())
+        return l_False;
+
     for (;;){
         CRef confl = propagate();
 
@@ -1976,12 +3063,13 @@ lbool Solver::search(int& nof_conflicts)
 			}
 			
             learnt_clause.clear();
+            learnt_fp = 0;
             if(conflicts>50000) DISTANCE=0;
             else DISTANCE=1;
             if(VSIDS && DISTANCE)
                 collectFirstUIP(confl);
 
-            analyze(confl, learnt_clause, backtrack_level, lbd);
+            analyze(confl, learnt_clause, backtrack_level, lbd, learnt_fp);
             // check chrono backtrack condition
             if ((confl_to_chrono < 0 || confl_to_chrono <= conflicts) && chrono > -1 && (decisionLevel() - backtrack_level) >= chrono)
             {
@@ -2013,13 +3101,11 @@ lbool Solver::search(int& nof_conflicts)
             }else{
                 CRef cr = ca.alloc(learnt_clause, true);
                 ca[cr].set_lbd(lbd);
+                ca[cr].fingerprint(learnt_fp);
                 //duplicate learnts 
                 int  id = 0;
                 if (lbd <= max_lbd_dup){                        
-                    std::vector<uint32_t> tmp;
-                    for (int i = 0; i < learnt_clause.size(); i++)
-                        tmp.push_back(learnt_clause[i].x);
-                    id = is_duplicate(tmp);             
+                    id = is_duplicate(learnt_fp);
                     if (id == min_number_of_learnts_copies +1){
                         duplicates_added_conflicts++;                        
                     }                    
@@ -2199,28 +3285,6 @@ static double luby(double y, int x){
 static bool switch_mode = false;
 //static void SIGALRM_switch(int signum) { switch_mode = true; }
 
-uint32_t Solver::reduceduplicates(){
-    uint32_t removed_duplicates = 0;
-    std::vector<std::vector<uint64_t>> tmp;
-    //std::map<int32_t,std::map<uint32_t,std::unordered_map<uint64_t,uint32_t>>>  ht;
-    for (auto & outer_mp: ht){//variables
-        for (auto &inner_mp:outer_mp.second){//sizes
-            for (auto &in_in_mp: inner_mp.second){
-                if (in_in_mp.second >= 2){
-                //min_number_of_learnts_copies
-                    tmp.push_back({outer_mp.first,inner_mp.first,in_in_mp.first,in_in_mp.second});
-                }
-            }                    
-         }
-    }          
-    removed_duplicates = dupl_db_size-tmp.size();  
-    ht.clear();
-    for (auto i=0;i<tmp.size();i++){
-        ht[tmp[i][0]][tmp[i][1]][tmp[i][2]]=tmp[i][3];
-    }
-    return removed_duplicates;
-}
-
 // NOTE: assumptions passed in member-variable 'assumptions'.
 lbool Solver::solve_()
 {
@@ -2258,25 +3322,23 @@ lbool Solver::solve_()
     duplicates_added_tier2 =0;    
 
     dupl_db_size=0;
-    size_t dupl_db_size_limit = dupl_db_init_size;
+    uint64_t dupl_db_report = dupl_db_max_size;
 
     // Search:
     int curr_restarts = 0;
     uint64_t curr_props = 0;
-    uint32_t removed_duplicates =0;
     while (status == l_Undef /*&& withinBudget()*/){
-        if (dupl_db_size >= dupl_db_size_limit){
+        if (dupl_db_size >= dupl_db_report){
             fprintf(stderr,"c Duplicate learnts added (Minimization) %i\n",duplicates_added_minimization);
             fprintf(stderr,"c Duplicate learnts added (conflicts) %i\n",duplicates_added_conflicts);
             fprintf(stderr,"c Duplicate learnts added (tier2) %i\n",duplicates_added_tier2);
-            fprintf(stderr,"c Duptime: %i\n",duptime.count());
+            fprintf(stderr,"c Duplicate table: %d entries, load %.2f, %.2f probes per lookup (max %u)\n",
+                    dup_table.size(), dup_table.load(), dup_table.avgProbes(), dup_table.maxProbes());
+            fprintf(stderr,"c Duplicate table: %llu evicted, %.1f MB\n",
+                    (unsigned long long)dup_table.nEvicted(), dup_table.bytes() / (1024.0 * 1024.0));
             fprintf(stderr,"c Number of conflicts: %i\n",conflicts);
             fprintf(stderr,"c Core size: %i\n",learnts_core.size());
-            
-            removed_duplicates = reduceduplicates();
-            dupl_db_size_limit*=1.1;
-            dupl_db_size -= removed_duplicates;
-            fprintf(stderr, "c removed duplicates %i\n",removed_duplicates);
+            dupl_db_report += dupl_db_max_size;
         }   
         if (propagations - curr_props >  VSIDS_props_limit){
             curr_props = propagations;
@@ -2294,23 +3356,42 @@ lbool Solver::solve_()
         if (switch_mode){ 
             switch_mode = false;
             VSIDS = !VSIDS;
-            if (VSIDS){
+            VMTF  = VSIDS && (vmtf_mode == 2 || (vmtf_mode == 1 && (vmtf_phases++ & 1)));
+            if (VSIDS && VMTF){
+                fprintf(stderr, "c Switched to VMTF.\n");
+            }
+            else if (VSIDS){
                 fprintf(stderr, "c Switched to VSIDS.\n");
             }
             else{
                 fprintf(stderr, "c Switched to LRB.\n");
             }
-            //            reduceduplicates();            
             fflush(stdout);
-            picked.clear();
-            conflicted.clear();
-            almost_conflicted.clear();
-#ifdef ANTI_EXPLORATION
-            canceled.clear();
-#endif
+            lrb.clear();
         }
     }
 
+    if (verbosity >= 1 && vivifier != NULL)
+        fprintf(stderr,"c Vivifier: %llu jobs, %llu propagations, %llu strengthened, %llu redundant\n",
+                (unsigned long long)vivifier->jobs, (unsigned long long)vivifier->propagations,
+                (unsigned long long)vivifier->strengthened, (unsigned long long)vivifier->redundant);
+    if (verbosity >= 1 && substituted > 0)
+        fprintf(stderr,"c Substituted %d equivalent variables\n", substituted);
+    if (verbosity >= 1)
+        fprintf(stderr,"c Binary implication graph: %llu transitive binaries removed, %llu failed literals, %llu necessary assignments, %llu hyper-binary resolvents\n",
+                (unsigned long long)transred_removed, (unsigned long long)probe_failed, (unsigned long long)probe_necessary, (unsigned long long)probe_hbrs);
+    if (verbosity >= 1)
+        fprintf(stderr,"c Learnt subsumption: %llu passes, %llu subsumed, %llu strengthened\n",
+                (unsigned long long)subsume_passes, (unsigned long long)subsumed_learnts, (unsigned long long)strengthened_learnts);
+    if (verbosity >= 1 && xors_found > 0)
+        fprintf(stderr,"c XOR constraints: %d found, %d rows in %d matrices, %llu propagations, %llu conflicts, %llu reasons made\n",
+                xors_found, xor_rows, xor_matrices.size(), (unsigned long long)xor_props,
+                (unsigned long long)xor_conflicts, (unsigned long long)xor_reasons);
+    if (verbosity >= 1)
+        fprintf(stderr,"c Clause arena: original region %llu bytes (%llu wasted), learnt region %llu bytes (%llu wasted), %llu collections (%llu of the original region)\n",
+                (unsigned long long)ca.size(false) * ClauseAllocator::Unit_Size, (unsigned long long)ca.wasted(false) * ClauseAllocator::Unit_Size,
+                (unsigned long long)ca.size(true)  * ClauseAllocator::Unit_Size, (unsigned long long)ca.wasted(true)  * ClauseAllocator::Unit_Size,
+                (unsigned long long)garbage_collections, (unsigned long long)original_collections);
     if (verbosity >= 1)
         fprintf(stderr,"c ===============================================================================\n");
 
@@ -2322,6 +3403,10 @@ lbool Solver::solve_()
         // Extend & copy model:
         model.growTo(nVars());
         for (int i = 0; i < nVars(); i++) model[i] = value(i);
+        for (int i = 0; i < nVars(); i++)
+            if (subst[i] != lit_Undef){
+                Lit p = substLit(mkLit(i));
+                model[i] = model[var(p)] ^ sign(p); }
     }else if (status == l_False && conflict.size() == 0)
         ok = false;
 
@@ -2410,6 +3495,50 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
 //=================================================================================================
 // Garbage Collection methods:
 
+// Relocates the clauses of all watch lists so that the ones propagation visits together end up
+// next to each other: the lists of the literals on the trail come first, in trail order, then the
+// remaining lists. Original, core and tier2 clauses are laid out ahead of the local tier, and binary
+// clauses, which propagation never dereferences, come last.
+void Solver::relocWatchesByLocality(ClauseAllocator& to)
+{
+    vec<Lit>  order;
+    vec<char> queued(2*nVars(), 0);
+    for (int i = 0; i < trail.size(); i++){
+        order.push(trail[i]);
+        queued[toInt(trail[i])] = 1; }
+    for (int i = 0; i < 2*nVars(); i++)
+        if (!queued[i]) order.push(toLit(i));
+
+    vec<CRef*> local;
+    for (int i = 0; i < order.size(); i++){
+        PoolVec<Watcher>& ws = watches[order[i]];
+        for (int j = 0; j < ws.size(); j++){
+            const Clause& c = ca[ws[j].cref];
+            if (c.learnt() && c.mark() == LOCAL)
+                local.push(&ws[j].cref);
+            else
+                ca.reloc(ws[j].cref, to); } }
+
+    for (int i = 0; i < local.size(); i++)
+        ca.reloc(*local[i], to);
+
+    for (int i = 0; i < order.size(); i++){
+        PoolVec<Watcher>& ws_bin = watches_bin[order[i]];
+        for (int j = 0; j < ws_bin.size(); j++)
+            ca.reloc(ws_bin[j].cref, to); }
+}
+
+// Copies the watch lists to fresh slabs of the pool, with the two lists of each literal side by side,
+// and returns the old slabs.
+void Solver::compactWatches()
+{
+    watch_pool.beginCompact();
+    for (int i = 0; i < 2*nVars(); i++){
+        watches_bin.compact(toLit(i));
+        watches    .compact(toLit(i)); }
+    watch_pool.endCompact();
+}
+
 void Solver::relocAll(ClauseAllocator& to)
 {
     // All watchers:
@@ -2417,26 +3546,32 @@ void Solver::relocAll(ClauseAllocator& to)
     // for (int i = 0; i < watches.size(); i++)
     watches.cleanAll();
     watches_bin.cleanAll();
-    for (int v = 0; v < nVars(); v++)
-        for (int s = 0; s < 2; s++){
-            Lit p = mkLit(v, s);
-            // printf(" >>> RELOCING: %s%d\n", sign(p)?"-":"", var(p)+1);
-            vec<Watcher>& ws = watches[p];
-            for (int j = 0; j < ws.size(); j++)
-                ca.reloc(ws[j].cref, to);
-            vec<Watcher>& ws_bin = watches_bin[p];
-            for (int j = 0; j < ws_bin.size(); j++)
-                ca.reloc(ws_bin[j].cref, to);
-        }
+    if (gc_locality)
+        relocWatchesByLocality(to);
+    else
+        for (int v = 0; v < nVars(); v++)
+            for (int s = 0; s < 2; s++){
+                Lit p = mkLit(v, s);
+                // printf(" >>> RELOCING: %s%d\n", sign(p)?"-":"", var(p)+1);
+                PoolVec<Watcher>& ws = watches[p];
+                for (int j = 0; j < ws.size(); j++)
+                    ca.reloc(ws[j].cref, to);
+                PoolVec<Watcher>& ws_bin = watches_bin[p];
+                for (int j = 0; j < ws_bin.size(); j++)
+                    ca.reloc(ws_bin[j].cref, to);
+            }
+    compactWatches();
 
     // All reasons:
     //
     for (int i = 0; i < trail.size(); i++){
         Var v = var(trail[i]);
 
-        if (reason(v) != CRef_Undef && (ca[reason(v)].reloced() || locked(ca[reason(v)])))
+        if (reason(v) != CRef_Undef && reason(v) != CRef_Xor && (ca[reason(v)].reloced() || locked(ca[reason(v)])))
             ca.reloc(vardata[v].reason, to);
     }
+    for (int i = 0; i < xor_temp.size(); i++)
+        ca.reloc(xor_temp[i], to);
 
     // All learnt:
     //
@@ -2455,6 +3590,17 @@ void Solver::relocAll(ClauseAllocator& to)
             ca.reloc(clauses[i], to);
             clauses[j++] = clauses[i]; }
     clauses.shrink(i - j);
+
+    // Clauses waiting to be exported:
+    //
+    if (redis != NULL){
+        vec<CRef>& exp = redis->learnts;
+        for (i = j = 0; i < exp.size(); i++)
+            if (ca[exp[i]].mark() != 1){
+                ca.reloc(exp[i], to);
+                exp[j++] = exp[i]; }
+        exp.shrink(i - j);
+    }
 }
 
 
@@ -2462,11 +3608,32 @@ void Solver::garbageCollect()
 {
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
-    ClauseAllocator to(ca.size() - ca.wasted());
+    ClauseAllocator to(ca.size(true) - ca.wasted(true));
+
+    // Only the learnt region churns. The original region is compacted only once it has wasted
+    // enough on its own, and otherwise stays in place together with all references into it.
+    if (ca.wasted(false) > ca.size(false) * garbage_frac){
+        to.collectOriginal(ca.size(false) - ca.wasted(false));
+        original_collections++; }
+
+    to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
 
+    uint64_t old_size = (uint64_t)ca.size()*ClauseAllocator::Unit_Size;
     relocAll(to);
-    if (verbosity >= 2)
-        printf("c |  Garbage collection:   %12d bytes => %12d bytes             |\n",
-               ca.size()*ClauseAllocator::Unit_Size, to.size()*ClauseAllocator::Unit_Size);
     to.moveTo(ca);
+    if (verbosity >= 2){
+        printf("c |  Garbage collection:   %12" PRIu64 " bytes => %12" PRIu64 " bytes             |\n",
+               old_size, (uint64_t)ca.size()*ClauseAllocator::Unit_Size);
+        // How fast propagation ran on the layout left by the previous collection:
+        double elapsed = cpuTime() - gc_time;
+        if (garbage_collections > 0 && elapsed > 0)
+            printf("c |  Since last collection: %12.0f props/sec                                |\n",
+                   (propagations - gc_propagations) / elapsed);
+        if (watch_pool.bytes() > 0)
+            printf("c |  Watch lists:          %12" PRIu64 " bytes                                  |\n",
+                   watch_pool.bytes()); }
+
+    garbage_collections++;
+    gc_propagations = propagations;
+    gc_time         = cpuTime();
 }
@@ -49,15 +49,14 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "mtl/Alg.h"
 #include "utils/Options.h"
 #include "core/SolverTypes.h"
+#include "core/Vivifier.h"
+#include "core/XorMatrix.h"
 
 
 // duplicate learnts version
-#include <chrono>
 #include <vector>
-#include <unordered_map>
 #include <unordered_set>
 #include <set>
-#include <map>
 #include <algorithm>
 #include "core/Redis.h"
 // duplicate learnts version
@@ -76,6 +75,7 @@ class Redis;
 
 class Solver {
     friend class Redis;
+    friend class XorMatrix;
 private:
     template<typename T>
     class MyQueue {
@@ -157,6 +157,7 @@ public:
     int     nLearnts   ()      const;       // The current number of learnt clauses.
     int     nVars      ()      const;       // The current number of variables.
     int     nFreeVars  ()      const;
+    virtual bool isEliminated(Var x) const { return false; } // Eliminated variables occur in no clause any more (see 'SimpSolver').
 
     // Resource contraints:
     //
@@ -191,11 +192,15 @@ public:
     double    random_var_freq;
     double    random_seed;
     bool      VSIDS;
+    int       vmtf_mode;          // Use VMTF instead of VSIDS in VSIDS phases (0=never, 1=every other phase, 2=always).
+    bool      VMTF;               // The current VSIDS phase orders decisions by VMTF.
     int       ccmin_mode;         // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
     int       phase_saving;       // Controls the level of phase saving (0=none, 1=limited, 2=full).
     bool      rnd_pol;            // Use random polarities for branching heuristics.
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
     double    garbage_frac;       // The fraction of wasted memory allowed before a garbage collection is triggered.
+    int       simd_watch_min;     // Clauses of at least this size use the vectorized replacement watch search (0 = never).
+    bool      gc_locality;        // Let garbage collection lay clauses out in the order propagation visits them.
 
     int       restart_first;      // The initial restart limit.                                                                (default 100)
     double    restart_inc;        // The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
@@ -210,9 +215,8 @@ public:
     // duplicate learnts version
     uint64_t       VSIDS_props_limit;
     uint32_t       min_number_of_learnts_copies;    
-    uint32_t       dupl_db_init_size;
+    uint32_t       dupl_db_max_size;
     uint32_t       max_lbd_dup;
-    std::chrono::microseconds duptime;
     // duplicate learnts version
 
     // Statistics: (read-only member variable)
@@ -220,22 +224,30 @@ public:
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts, conflicts_VSIDS;
     uint64_t dec_vars, clauses_literals, learnts_literals, max_literals, tot_literals;
     uint64_t chrono_backtrack, non_chrono_backtrack;
+    uint64_t garbage_collections, gc_propagations;  // Number of collections, and 'propagations' at the last one.
+    uint64_t original_collections;                  // Number of collections that compacted the original region too.
+    double   gc_time;                               // CPU time of the last collection.
 
 
     // duplicate learnts version
     uint64_t duplicates_added_conflicts;
     uint64_t duplicates_added_tier2;
     uint64_t duplicates_added_minimization;    
-    uint64_t dupl_db_size;
+    uint64_t dupl_db_size;                          // Lookups in the duplicates DB.
     
     // duplicate learnts version
 
-    vec<uint32_t> picked;
-    vec<uint32_t> conflicted;
-    vec<uint32_t> almost_conflicted;
+    // LRB bookkeeping, kept in one record per variable since 'uncheckedEnqueue()' and 'cancelUntil()'
+    // touch all of it for every assignment:
+    struct LrbData {
+        uint32_t picked;            // 'conflicts' when the variable was last assigned.
+        uint32_t conflicted;        // Times it took part in a conflict since then.
+        uint32_t almost_conflicted; // Times it appeared in a reason of the learnt clause since then.
 #ifdef ANTI_EXPLORATION
-    vec<uint32_t> canceled;
+        uint32_t canceled;          // 'conflicts' when it was last unassigned or decayed.
 #endif
+    };
+    vec<LrbData> lrb;
 
 protected:
 
@@ -287,10 +299,12 @@ protected:
     vec<double>         activity_CHB,     // A heuristic measurement of the activity of a variable.
     activity_VSIDS,activity_distance;
     double              var_inc;          // Amount to bump next variable with.
-    OccLists<Lit, vec<Watcher>, WatcherDeleted>
+    VecPool<Watcher>    watch_pool;       // Storage shared by the watch lists below.
+    PooledOccLists<Lit, Watcher, WatcherDeleted>
     watches_bin,      // Watches for binary clauses only.
     watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
     vec<lbool>          assigns;          // The current assignments.
+    vec<lbool>          lit_assigns;      // The current value of each literal, indexed by 'toInt(p)' (mirrors 'assigns').
     vec<char>           polarity;         // The preferred polarity of each variable.
     vec<char>           decision;         // Declares if a variable is eligible for selection in the decision heuristic.
     vec<Lit>            trail;            // Assignment stack; stores all assigments made in the order they were made.
@@ -302,6 +316,20 @@ protected:
     vec<Lit>            assumptions;      // Current set of assumptions provided to solve by the user.
     Heap<VarOrderLt>    order_heap_CHB,   // A priority queue of variables ordered with respect to the variable activity.
     order_heap_VSIDS,order_heap_distance;
+    Heap<VarOrderLt>*   order_heap_active;// The heap of the current mode (see 'orderHeap()'), or NULL under VMTF. The others are kept empty.
+
+    // VMTF decision queue: variables in the order they were last bumped, the most recent at the end.
+    // Every variable after 'vmtf_cursor' is assigned, so decisions search backwards from there.
+    struct VmtfLink { Var prev, next; uint64_t stamp; };
+    struct VmtfStampLt {
+        const vec<VmtfLink>& links;
+        bool operator () (Lit x, Lit y) const { return links[var(x)].stamp < links[var(y)].stamp; }
+        VmtfStampLt(const vec<VmtfLink>& l) : links(l) { }
+    };
+    vec<VmtfLink>       vmtf_links;
+    Var                 vmtf_first, vmtf_last, vmtf_cursor;
+    uint64_t            vmtf_stamp;       // Stamp of the most recent bump.
+    uint64_t            vmtf_phases;      // Number of VSIDS phases started (for 'vmtf_mode' 1).
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
 
@@ -313,8 +341,7 @@ protected:
     next_L_reduce;
     
     // duplicate learnts version    
-    std::map<uint32_t,std::map<uint32_t,std::unordered_map<uint64_t,uint32_t>>>  ht;
-    uint32_t     reduceduplicates         ();         // Reduce the duplicates DB
+    DupTable     dup_table;                           // How often each learnt clause was derived.
     // duplicate learnts version
 
     int 				confl_to_chrono;
@@ -344,6 +371,12 @@ protected:
 
     // Main internal methods:
     //
+    Heap<VarOrderLt>& orderHeap();                                                     // The decision heap of the current mode ('DISTANCE', 'VSIDS').
+    bool     vmtfActive       ();                                                      // True if decisions currently come from the VMTF queue.
+    void     vmtfEnqueue      (Var v);                                                 // Move 'v' to the end of the VMTF queue.
+    void     vmtfBump         (vec<Lit>& lits);                                        // Move the variables of 'lits' to the end, keeping their relative order.
+    Var      vmtfPick         ();                                                      // The most recently bumped unassigned decision variable.
+    void     activateOrderHeap(Heap<VarOrderLt>& h);                                   // (helper method for 'orderHeap()')
     void     insertVarOrder   (Var x);                                                 // Insert a variable in the decision order priority queue.
     Lit      pickBranchLit    ();                                                      // Return the next decision variable.
     void     newDecisionLevel ();                                                      // Begins a new decision level.
@@ -351,22 +384,26 @@ protected:
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     CRef     propagate        ();                                                      // Perform unit propagation. Returns possibly conflicting clause.
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
-    void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd);    // (bt = backtrack)
+    void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd, uint64_t& out_fp); // (bt = backtrack, fp = fingerprint)
     void     analyzeFinal     (Lit p, vec<Lit>& out_conflict);                         // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p, uint32_t abstract_levels);                       // (helper method for 'analyze()')
     lbool    search           (int& nof_conflicts);                                    // Search for a given number of conflicts.
+    virtual bool inprocess    () { return true; }                                      // Further simplification at the start of each restart, at level 0.
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
     void     reduceDB_Tier2   ();
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
     void     safeRemoveSatisfied(vec<CRef>& cs, unsigned valid_mark);
     void     rebuildOrderHeap ();
-    bool     binResMinimize   (vec<Lit>& out_learnt);                                  // Further learnt clause minimization by binary resolution.
+    bool     binResMinimize   (vec<Lit>& out_learnt, uint64_t& fp);                    // Further learnt clause minimization by binary resolution.
 
     // Maintaining Variable/Clause activity:
     //
     void     varDecayActivity ();                      // Decay all variables with the specified factor. Implemented by increasing the 'bump' value instead.
     void     varBumpActivity  (Var v, double mult);    // Increase a variable with the current 'bump' value.
+#ifdef ANTI_EXPLORATION
+    void     decayActivityCHB (Var v);                 // Decay the CHB activity of 'v' for the conflicts since 'lrb[v].canceled'.
+#endif
     void     claDecayActivity ();                      // Decay all clauses with the specified factor. Implemented by increasing the 'bump' value instead.
     void     claBumpActivity  (Clause& c);             // Increase a clause with the current 'bump' value.
 
@@ -379,9 +416,11 @@ protected:
     bool     satisfied        (const Clause& c) const; // Returns TRUE if a clause is satisfied in the current state.
 
     void     relocAll         (ClauseAllocator& to);
+    void     relocWatchesByLocality(ClauseAllocator& to); // (helper method for 'relocAll()')
+    void     compactWatches   ();                         // (helper method for 'relocAll()')
 
 // duplicate learnts version
-    int     is_duplicate     (std::vector<uint32_t>&c); //returns TRUE if a clause is duplicate
+    int     is_duplicate     (uint64_t fp);       // Returns how often the clause with fingerprint 'fp' was derived before this time (0 if new, otherwise at least 2).
 // duplicate learnts version
 
     // Misc:
@@ -389,6 +428,7 @@ protected:
     int      decisionLevel    ()      const; // Gives the current decisionlevel.
     uint32_t abstractLevel    (Var x) const; // Used to represent an abstraction of sets of decision levels.
     CRef     reason           (Var x) const;
+    CRef     reasonClause     (Var x);       // The reason of 'x' as a clause (made first if an XOR matrix implied 'x').
     
     ConflictData FindConflictLevel(CRef cind);
     
@@ -471,8 +511,7 @@ public:
     bool	simplifyAll();
     void	simplifyLearnt(Clause& c);
     bool	simplifyLearnt_x(vec<CRef>& learnts_x);
-    bool	simplifyLearnt_core();
-    bool	simplifyLearnt_tier2();
+    bool	vivifyLearnt(CRef cr);
     int		trailRecord;
     void	litsEnqueue(int cutP, Clause& c);
     void	cancelUntilTrailRecord();
@@ -481,6 +520,101 @@ public:
     uint64_t nbSimplifyAll;
     uint64_t simplified_length_record, original_length_record;
     uint64_t s_propagations;
+    double   vivify_effort;         // Budget of a call to 'simplifyAll()', relative to the propagations since the last.
+    double   vivify_local;          // Same for the local tier.
+    uint64_t vivify_props;          // 'propagations' at the last call.
+    vec<CRef> vivify_queue;
+    Vivifier* vivifier;             // Helper thread that vivifies the queue instead, or NULL.
+    uint64_t  clause_deletions;     // Calls of 'removeClause()'.
+    uint64_t  vivify_epoch;         // 'clause_deletions' when the helper thread took its snapshot.
+    uint64_t  original_changes;     // Deletions and in-place rewrites of original clauses.
+    uint64_t  vivify_base_epoch;    // 'original_changes' when the helper thread took its copy of the original clauses.
+    void      startVivifier();
+    bool      applyVivified();
+    void      cleanTiers();
+    void      exportNewClauses();
+
+    // Equivalent literal substitution:
+    bool      subst_equiv;          // Substitute equivalent literals between restarts.
+    vec<Lit>  subst;                // The literal each variable was replaced by, or 'lit_Undef'.
+    int       substituted;          // Number of variables replaced.
+    Lit       substLit(Lit p) const;
+    bool      substitute(vec<Lit>& ps);         // Replaces substituted literals. Returns FALSE if 'ps' became a tautology.
+    bool      findEquivalences(int& found);     // Returns FALSE if a literal is equivalent to its negation.
+    bool      substituteEquivalences();
+
+    // Transitive reduction and probing of the binary implication graph:
+    double    transred_effort;      // Edges visited by 'transitiveReduction()' per propagation of search.
+    double    probe_effort;         // Propagations spent by 'probe()' per propagation of search.
+    int       transred_next;        // Literal (as 'toInt()') to continue 'transitiveReduction()' from.
+    int       probe_next;           // Literal (as 'toInt()') to continue 'probe()' from.
+    vec<uint32_t> bin_stamp;        // Per literal: the search of 'binReach()' that last visited it.
+    uint32_t  bin_stamp_cur;
+    vec<Lit>  probe_parent;         // Per variable: its parent in the implication tree of the probe.
+    vec<int>  probe_depth;
+    vec<Lit>  probe_hbr;            // Hyper-binary resolvents of the probe, as pairs of literals.
+    struct ProbeFrame { Lit x; int next; };
+    vec<ProbeFrame> probe_path;     // Path of 'probeTree()' through the binary implication graph,
+    vec<int>  probe_lim;            // and the size of the trail before each probe on it.
+    vec<Lit>  probe_units;          // Units found by 'probeTree()', enqueued once it is done.
+    uint32_t  probe_pass;           // Number of calls to 'probe()'.
+    vec<uint32_t> implied_pass;     // Per literal: the call to 'probe()' in which a probe last implied it,
+    vec<Lit>  implied_by;           // and that probe.
+    uint64_t  bin_ticks, transred_removed, probe_failed, probe_necessary, probe_hbrs;
+    void      nextBinStamp();
+    Lit       binReach(Lit from, Lit to, CRef skip, bool irredundant);
+    bool      transitiveReduction(uint64_t budget);
+    Lit       probeDominator(Lit p, Lit q) const;
+    bool      probeRoot(Lit r);
+    void      probeUnit(Lit u);
+    void      probeImplied(Lit p, int start);
+    bool      probeTree(Lit r, uint64_t budget);
+    bool      probe(uint64_t budget);
+
+    // Subsumption among the learnt clauses:
+    double    subsume_effort;       // Occurrences scanned by 'subsumeLearnts()' per propagation of search.
+    int       subsume_next;         // Learnt clause to continue 'subsumeLearnts()' from.
+    vec<vec<int> >  subsume_occs;   // Per literal: the clauses it watches (by index), one literal per clause.
+    uint64_t  subsume_ticks, subsumed_learnts, strengthened_learnts;
+    uint64_t  subsume_saved;        // Budget of the calls that could not afford to set up the occurrences.
+    uint64_t  subsume_passes;
+    bool      subsumeLearnts(uint64_t budget);
+
+    // XOR constraints, propagated by Gaussian elimination (see 'XorMatrix'):
+    bool      use_xor;
+    int       xor_max_size;         // Longest XOR constraint to detect.
+    int       xor_max_vars;         // Most variables of one matrix.
+    bool      xor_stale;            // The matrices sit out propagation until 'buildXors()' is called.
+    vec<XorMatrix*> xor_matrices;
+    vec<int>  xor_mat;              // Per variable: its matrix, or -1,
+    vec<int>  xor_col;              // and its column there.
+    vec<int>  xor_snap;             // Per variable implied by a matrix: where 'xor_snaps' keeps the row that did.
+    vec<uint64_t> xor_snaps;        // Copies of the rows that implied something, in the order of the trail.
+    vec<CRef> xor_temp;             // Reasons and conflicts made from rows, freed on backtracking.
+    vec<Lit>  xor_lits;
+    int       xor_qhead;            // Head of the queue of 'xorPropagate()' (as index into the trail).
+    int       xors_found, xor_rows;
+    uint64_t  xor_props, xor_conflicts, xor_reasons;
+    bool      buildXors();
+    CRef      xorPropagate();
+    void      xorEnqueue(Lit p, int level, const uint64_t* row, int words);
+    CRef      xorAlloc();
+    CRef      xorConflict(const XorMatrix& m, const uint64_t* row);
+    CRef      xorReason(Var x);
+
+    // Clauses to vivify first: those with the lowest LBD, and of these the most recently used.
+    struct VivifyLt {
+        ClauseAllocator& ca;
+        VivifyLt(ClauseAllocator& ca_) : ca(ca_) {}
+        bool operator () (CRef x, CRef y) const {
+            Clause& a = ca[x]; Clause& b = ca[y];
+            return a.lbd() < b.lbd() || (a.lbd() == b.lbd() && a.touched() > b.touched()); }
+    };
+    struct ActivityGt {
+        ClauseAllocator& ca;
+        ActivityGt(ClauseAllocator& ca_) : ca(ca_) {}
+        bool operator () (CRef x, CRef y) const { return ca[x].activity() > ca[y].activity(); }
+    };
 
     vec<Lit> simp_learnt_clause;
     vec<CRef> simp_reason_clause;
@@ -511,11 +645,37 @@ public:
 // Implementation of inline methods:
 
 inline CRef Solver::reason(Var x) const { return vardata[x].reason; }
+inline CRef Solver::reasonClause(Var x) { CRef r = vardata[x].reason; return r != CRef_Xor ? r : xorReason(x); }
 inline int  Solver::level (Var x) const { return vardata[x].level; }
 
-inline void Solver::insertVarOrder(Var x) {
-    //    Heap<VarOrderLt>& order_heap = VSIDS ? order_heap_VSIDS : order_heap_CHB;
+inline Lit Solver::substLit(Lit p) const {
+    while (subst[var(p)] != lit_Undef) p = subst[var(p)] ^ sign(p);
+    return p; }
+
+// Only the heap of the current mode is maintained. When the mode changes, the heap of the new mode
+// is rebuilt from scratch and the old one is emptied, so activity updates on inactive heaps find
+// nothing to do:
+inline Heap<Solver::VarOrderLt>& Solver::orderHeap() {
     Heap<VarOrderLt>& order_heap = DISTANCE ? order_heap_distance : ((!VSIDS)? order_heap_CHB:order_heap_VSIDS);
+    if (&order_heap != order_heap_active) activateOrderHeap(order_heap);
+    return order_heap; }
+
+// VMTF takes the place of the VSIDS heap, which is emptied on the way in and rebuilt by 'orderHeap()'
+// on the way out. LRB phases never use it, as 'analyze()' only bumps it in VSIDS phases:
+inline bool Solver::vmtfActive() {
+    if (!VSIDS || !VMTF || DISTANCE) return false;
+    if (order_heap_active != NULL){
+        order_heap_active->clear(true);
+        order_heap_active = NULL;
+        vmtf_cursor = vmtf_last; }
+    return true; }
+
+inline void Solver::insertVarOrder(Var x) {
+    if (vmtfActive()){
+        if (vmtf_cursor == var_Undef || vmtf_links[x].stamp > vmtf_links[vmtf_cursor].stamp)
+            vmtf_cursor = x;
+        return; }
+    Heap<VarOrderLt>& order_heap = orderHeap();
     if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
 
 inline void Solver::varDecayActivity() {
@@ -553,14 +713,15 @@ inline bool     Solver::addClause       (Lit p, Lit q)          { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); return addClause_(add_tmp); }
 inline bool     Solver::locked          (const Clause& c) const {
     int i = c.size() != 2 ? 0 : (value(c[0]) == l_True ? 0 : 1);
-    return value(c[i]) == l_True && reason(var(c[i])) != CRef_Undef && ca.lea(reason(var(c[i]))) == &c;
+    CRef r = reason(var(c[i]));
+    return value(c[i]) == l_True && r != CRef_Undef && r != CRef_Xor && ca.lea(r) == &c;
 }
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
 inline uint32_t Solver::abstractLevel (Var x) const   { return 1 << (level(x) & 31); }
 inline lbool    Solver::value         (Var x) const   { return assigns[x]; }
-inline lbool    Solver::value         (Lit p) const   { return assigns[var(p)] ^ sign(p); }
+inline lbool    Solver::value         (Lit p) const   { return lit_assigns[toInt(p)]; }
 inline lbool    Solver::modelValue    (Var x) const   { return model[x]; }
 inline lbool    Solver::modelValue    (Lit p) const   { return model[var(p)] ^ sign(p); }
 inline int      Solver::nAssigns      ()      const   { return trail.size(); }
@@ -575,10 +736,7 @@ inline void     Solver::setDecisionVar(Var v, bool b)
     else if (!b &&  decision[v]) dec_vars--;
 
     decision[v] = b;
-    if (b && !order_heap_CHB.inHeap(v)){
-        order_heap_CHB.insert(v);
-        order_heap_VSIDS.insert(v);
-        order_heap_distance.insert(v);}
+    insertVarOrder(v);
 }
 inline void     Solver::setConfBudget(int64_t x){ conflict_budget    = conflicts    + x; }
 inline void     Solver::setPropBudget(int64_t x){ propagation_budget = propagations + x; }
@@ -31,12 +31,14 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Minisat_SolverTypes_h
 
 #include <assert.h>
+#include <math.h>
 
 #include "mtl/IntTypes.h"
 #include "mtl/Alg.h"
 #include "mtl/Vec.h"
 #include "mtl/Map.h"
 #include "mtl/Alloc.h"
+#include "mtl/Pool.h"
 #include <iostream>
 
 namespace Minisat {
@@ -74,6 +76,14 @@ inline  int  toInt     (Var v)              { return v; }
 inline  int  toInt     (Lit p)              { return p.x; } 
 inline  Lit  toLit     (int i)              { Lit p; p.x = i; return p; } 
 
+// A 64-bit hash of a literal. The sum of the hashes of its literals is the fingerprint of a clause;
+// it does not depend on their order and follows the clause as literals are added or removed.
+inline  uint64_t litHash(Lit p) {
+    uint64_t x = (uint64_t)p.x + 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31); }
+
 //const Lit lit_Undef = mkLit(var_Undef, false);  // }- Useful special constants.
 //const Lit lit_Error = mkLit(var_Undef, true );  // }
 
@@ -171,21 +181,33 @@ class Clause {
             if (header.learnt){
                 data[header.size].act = 0;
                 data[header.size+1].touched = 0;
+                fingerprint(0);
             }else
                 calcAbstraction(); }
     }
 
 public:
     void calcAbstraction() {
-        assert(header.has_extra);
+        assert(header.has_extra && !header.learnt);
+        data[header.size].abs = abstractLits();  }
+
+    // The abstraction of the literals, for clauses that have no room to store it:
+    uint32_t abstractLits() const {
         uint32_t abstraction = 0;
         for (int i = 0; i < size(); i++)
             abstraction |= 1 << (var(data[i].lit) & 31);
-        data[header.size].abs = abstraction;  }
+        return abstraction;  }
+
+    void calcFingerprint() {
+        uint64_t fp = 0;
+        for (int i = 0; i < size(); i++)
+            fp += litHash(data[i].lit);
+        fingerprint(fp); }
 
 
     int          size        ()      const   { return header.size; }
-    void         shrink      (int i)         { assert(i <= size()); if (header.has_extra) data[header.size-i] = data[header.size]; header.size -= i; }
+    int          extras      ()      const   { return header.learnt ? 4 : header.has_extra; }
+    void         shrink      (int i)         { assert(i <= size()); for (int k = 0; k < extras(); k++) data[header.size-i+k] = data[header.size+k]; header.size -= i; }
     void         pop         ()              { shrink(1); }
     bool         learnt      ()      const   { return header.learnt; }
     bool         has_extra   ()      const   { return header.has_extra; }
@@ -203,16 +225,19 @@ public:
     void         removable   (bool b)        { header.removable = b; }
 
     // NOTE: somewhat unsafe to change the clause in-place! Must manually call 'calcAbstraction' afterwards for
-    //       subsumption operations to behave correctly.
+    //       subsumption operations to behave correctly, and 'calcFingerprint' for learnt clauses.
     Lit&         operator [] (int i)         { return data[i].lit; }
     Lit          operator [] (int i) const   { return data[i].lit; }
     operator const Lit* (void) const         { return (Lit*)data; }
 
     uint32_t&    touched     ()              { assert(header.has_extra && header.learnt); return data[header.size+1].touched; }
     float&       activity    ()              { assert(header.has_extra); return data[header.size].act; }
-    uint32_t     abstraction () const        { assert(header.has_extra); return data[header.size].abs; }
+    uint32_t     abstraction () const        { assert(header.has_extra && !header.learnt); return data[header.size].abs; }
+    uint64_t     fingerprint () const        { assert(header.learnt); return (uint64_t)data[header.size+3].abs << 32 | data[header.size+2].abs; }
+    void         fingerprint (uint64_t fp)   { assert(header.learnt); data[header.size+2].abs = (uint32_t)fp; data[header.size+3].abs = fp >> 32; }
 
     Lit          subsumes    (const Clause& other) const;
+    Lit          subsumes    (const Clause& other, uint32_t abst, uint32_t other_abst) const;
     void         strengthen  (Lit p);
     // simplify
     //
@@ -223,52 +248,91 @@ public:
 
 //=================================================================================================
 // ClauseAllocator -- a simple class for allocating memory for clauses:
+//
+// Original and learnt clauses live in two separate regions. Problem clauses rarely die while the
+// learnt tiers churn constantly, so a garbage collection can compact the learnt region on its own
+// and leave the original region, and every reference into it, where it is. The top bit of a 'CRef'
+// selects the region, which leaves each region half of the 32-bit range.
 
 
 const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
-class ClauseAllocator : public RegionAllocator<uint32_t>
+const CRef CRef_Xor   = CRef_Undef - 1;     // The reason of a literal an XOR matrix implied, until it is made a clause.
+class ClauseAllocator
 {
+    static const CRef Learnt_Bit = 0x80000000;
+    static const CRef Index_Mask = 0x7fffffff;
+
+    RegionAllocator<uint32_t> regions[2];      // Original clauses, learnt clauses.
+    bool                      collect_original; // FALSE if this is the target of a collection of the learnt region only.
+
     static int clauseWord32Size(int size, int extras){
         return (sizeof(Clause) + (sizeof(Lit) * (size + extras))) / sizeof(uint32_t); }
+
+    RegionAllocator<uint32_t>&       region(CRef r)       { return regions[r >> 31]; }
+    const RegionAllocator<uint32_t>& region(CRef r) const { return regions[r >> 31]; }
 public:
+    typedef CRef Ref;
+    enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
+
     bool extra_clause_field;
 
-    ClauseAllocator(uint32_t start_cap) : RegionAllocator<uint32_t>(start_cap), extra_clause_field(false){}
-    ClauseAllocator() : extra_clause_field(false){}
+    ClauseAllocator() : collect_original(true), extra_clause_field(false){}
+
+    // Target of a garbage collection: 'learnt_cap' sizes the new learnt region, and the original
+    // region stays in place unless 'collectOriginal()' is called as well.
+    explicit ClauseAllocator(uint32_t learnt_cap) : collect_original(false), extra_clause_field(false){
+        RegionAllocator<uint32_t>(0).moveTo(regions[0]);
+        RegionAllocator<uint32_t>(learnt_cap).moveTo(regions[1]); }
+
+    void collectOriginal(uint32_t start_cap){
+        RegionAllocator<uint32_t>(start_cap).moveTo(regions[0]);
+        collect_original = true; }
+
+    uint32_t size  ()            const { return regions[0].size() + regions[1].size(); }
+    uint32_t wasted()            const { return regions[0].wasted() + regions[1].wasted(); }
+    uint32_t size  (bool learnt) const { return regions[learnt].size(); }
+    uint32_t wasted(bool learnt) const { return regions[learnt].wasted(); }
 
     void moveTo(ClauseAllocator& to){
         to.extra_clause_field = extra_clause_field;
-        RegionAllocator<uint32_t>::moveTo(to); }
+        if (collect_original)
+            regions[0].moveTo(to.regions[0]);
+        regions[1].moveTo(to.regions[1]); }
 
     template<class Lits>
     CRef alloc(const Lits& ps, bool learnt = false)
     {
         assert(sizeof(Lit)      == sizeof(uint32_t));
         assert(sizeof(float)    == sizeof(uint32_t));
-        int extras = learnt ? 2 : (int)extra_clause_field;
+        int extras = learnt ? 4 : (int)extra_clause_field;
 
-        CRef cid = RegionAllocator<uint32_t>::alloc(clauseWord32Size(ps.size(), extras));
+        CRef cid = regions[learnt].alloc(clauseWord32Size(ps.size(), extras));
+        if (cid >= Index_Mask - 1)                  // (the last learnt reference would be 'CRef_Xor')
+            throw OutOfMemoryException();
+        if (learnt) cid |= Learnt_Bit;
         new (lea(cid)) Clause(ps, extra_clause_field, learnt);
 
         return cid;
     }
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
-    Clause&       operator[](Ref r)       { return (Clause&)RegionAllocator<uint32_t>::operator[](r); }
-    const Clause& operator[](Ref r) const { return (Clause&)RegionAllocator<uint32_t>::operator[](r); }
-    Clause*       lea       (Ref r)       { return (Clause*)RegionAllocator<uint32_t>::lea(r); }
-    const Clause* lea       (Ref r) const { return (Clause*)RegionAllocator<uint32_t>::lea(r); }
-    Ref           ael       (const Clause* t){ return RegionAllocator<uint32_t>::ael((uint32_t*)t); }
+    Clause&       operator[](Ref r)       { return (Clause&)region(r)[r & Index_Mask]; }
+    const Clause& operator[](Ref r) const { return (Clause&)region(r)[r & Index_Mask]; }
+    Clause*       lea       (Ref r)       { return (Clause*)region(r).lea(r & Index_Mask); }
+    const Clause* lea       (Ref r) const { return (Clause*)region(r).lea(r & Index_Mask); }
+    Ref           ael       (const Clause* t){
+        return t->learnt() ? regions[1].ael((uint32_t*)t) | Learnt_Bit : regions[0].ael((uint32_t*)t); }
 
     void free(CRef cid)
     {
         Clause& c = operator[](cid);
-        int extras = c.learnt() ? 2 : (int)c.has_extra();
-        RegionAllocator<uint32_t>::free(clauseWord32Size(c.size(), extras));
+        region(cid).free(clauseWord32Size(c.size(), c.extras()));
     }
 
     void reloc(CRef& cr, ClauseAllocator& to)
     {
+        if (!(cr & Learnt_Bit) && !to.collect_original) return;
+
         Clause& c = operator[](cr);
         
         if (c.reloced()) { cr = c.relocation(); return; }
@@ -282,6 +346,7 @@ public:
         if (to[cr].learnt()){
             to[cr].touched() = c.touched();
             to[cr].activity() = c.activity();
+            to[cr].fingerprint(c.fingerprint());
             to[cr].set_lbd(c.lbd());
             to[cr].removable(c.removable());
             // simplify
@@ -309,6 +374,7 @@ inline std::ostream& operator<<(std::ostream& out, const Clause& cls)
 template<class Idx, class Vec, class Deleted>
 class OccLists
 {
+protected:
     vec<Vec>  occs;
     vec<char> dirty;
     vec<Idx>  dirties;
@@ -363,6 +429,33 @@ void OccLists<Idx,Vec,Deleted>::clean(const Idx& idx)
 }
 
 
+//=================================================================================================
+// PooledOccLists -- occurence lists whose vectors share the storage of a 'VecPool':
+//
+// Several lists may be bound to the same pool. Without a pool, the vectors are allocated one by one
+// as in 'OccLists'.
+
+template<class Idx, class T, class Deleted>
+class PooledOccLists : public OccLists<Idx, PoolVec<T>, Deleted>
+{
+    typedef OccLists<Idx, PoolVec<T>, Deleted> Base;
+    VecPool<T>* pool;
+
+public:
+    PooledOccLists(const Deleted& d) : Base(d), pool(NULL) {}
+
+    void  bind      (VecPool<T>* p){ assert(this->occs.size() == 0); pool = p; }
+    void  init      (const Idx& idx){
+        int from = this->occs.size();
+        Base::init(idx);
+        for (int i = from; i < this->occs.size(); i++)
+            this->occs[i].bind(pool);
+    }
+    // Moves the list of 'idx' to the front of the pool (see 'VecPool::beginCompact()'):
+    void  compact   (const Idx& idx){ this->occs[toInt(idx)].compact(); }
+};
+
+
 //=================================================================================================
 // CMap -- a class for mapping clauses to values:
 
@@ -405,6 +498,130 @@ public:
 };
 
 
+//=================================================================================================
+// DupTable -- counts how often each learnt clause was derived, keyed by a 64-bit fingerprint:
+//
+// A flat open-addressing table with linear probing and a fixed maximal number of entries; it is kept
+// at most half full. Once full, every new entry evicts an old one chosen by a CLOCK sweep: each
+// lookup gives its entry a few lives (more for clauses seen more often), and the hand takes one life
+// from every entry it passes until it finds one without any. The fingerprint 0 marks an empty slot,
+// so callers must not use it as a key.
+
+class DupTable
+{
+    enum { Min_Cap = 1024, Max_Lives = 3 };
+
+    struct Slot {
+        uint64_t key;
+        uint32_t count;
+        uint32_t lives;
+    };
+
+    vec<Slot>     slots;
+    uint32_t      mask;       // Capacity minus one (the capacity is a power of two).
+    int           elems;
+    int           max_elems;
+    uint32_t      hand;       // Position of the CLOCK hand.
+
+    // Statistics:
+    uint64_t      lookups, probes, evictions;
+    uint32_t      max_probe;
+
+    void rehash(uint32_t cap) {
+        vec<Slot> old;
+        slots.moveTo(old);
+        Slot empty = { 0, 0, 0 };
+        slots.growTo(cap, empty);
+        mask = cap - 1;
+        hand = 0;
+        for (int i = 0; i < old.size(); i++)
+            if (old[i].key != 0){
+                uint32_t j = (uint32_t)old[i].key & mask;
+                while (slots[j].key != 0) j = (j + 1) & mask;
+                slots[j] = old[i]; }
+    }
+
+    // Empties slot 'i', moving later entries of its cluster back so that no lookup stops short:
+    void remove(uint32_t i) {
+        for (uint32_t j = (i + 1) & mask; slots[j].key != 0; j = (j + 1) & mask){
+            uint32_t home = (uint32_t)slots[j].key & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)){
+                slots[i] = slots[j];
+                i = j; } }
+        slots[i].key = 0;
+        elems--;
+    }
+
+    void evict() {
+        for (;; hand = (hand + 1) & mask){
+            Slot& s = slots[hand];
+            if (s.key == 0) continue;
+            if (s.lives == 0) break;
+            s.lives--; }
+        remove(hand);
+        evictions++;
+    }
+
+public:
+    DupTable() : mask(0), elems(0), max_elems(0), hand(0), lookups(0), probes(0), evictions(0), max_probe(0) { }
+
+    // Sets the maximal number of entries (and clears the table):
+    void init(int max_entries) {
+        max_elems = max_entries;
+        elems     = 0;
+        slots.clear(true);
+        rehash(Min_Cap);
+    }
+
+    int      size     () const { return elems; }
+    double   load     () const { return (double)elems / (mask + 1); }
+    double   avgProbes() const { return lookups == 0 ? 0 : (double)probes / lookups; }
+    uint32_t maxProbes() const { return max_probe; }
+    uint64_t nEvicted () const { return evictions; }
+    uint64_t bytes    () const { return (uint64_t)slots.size() * sizeof(Slot); }
+
+    // The count of 'key', which is inserted with a count of 0 if absent:
+    uint32_t& operator [] (uint64_t key) {
+        assert(key != 0 && max_elems > 0);
+        uint32_t i = (uint32_t)key & mask, n = 1;
+        while (slots[i].key != 0 && slots[i].key != key)
+            i = (i + 1) & mask, n++;
+        lookups++;
+        probes += n;
+        if (n > max_probe) max_probe = n;
+
+        if (slots[i].key == 0){
+            bool full = elems >= max_elems;
+            if (full || (uint64_t)(elems + 1) * 2 > (uint64_t)(mask + 1)){
+                if (full) evict();
+                else      rehash(2 * (mask + 1));
+                // The free slot may have moved:
+                for (i = (uint32_t)key & mask; slots[i].key != 0; i = (i + 1) & mask); }
+            slots[i].key   = key;
+            slots[i].count = 0;
+            elems++; }
+
+        slots[i].lives = slots[i].count < Max_Lives ? slots[i].count + 1 : Max_Lives;
+        return slots[i].count;
+    }
+};
+
+//=================================================================================================
+// AntiExplorationDecay -- the anti-exploration decay '0.95^age' of LRB, without calling 'pow()':
+//
+// Looked up as '0.95^(age % 1024) * 0.95^(1024 * (age / 1024))'. From an age of 16384 on, the power
+// underflows to 0 in double precision anyway.
+
+class AntiExplorationDecay {
+    double lo[1024], hi[16];
+public:
+    AntiExplorationDecay() {
+        for (int i = 0; i < 1024; i++) lo[i] = pow(0.95, i);
+        for (int i = 0; i < 16;   i++) hi[i] = pow(0.95, 1024 * i); }
+    double operator () (uint32_t age) const { return age >= 16384 ? 0 : lo[age & 1023] * hi[age >> 10]; }
+};
+
+
 /*_________________________________________________________________________________________________
 |
 |  subsumes : (other : const Clause&)  ->  Lit
@@ -424,7 +641,13 @@ inline Lit Clause::subsumes(const Clause& other) const
     //if (other.size() < size() || (!learnt() && !other.learnt() && (extra.abst & ~other.extra.abst) != 0))
     assert(!header.learnt);   assert(!other.header.learnt);
     assert(header.has_extra); assert(other.header.has_extra);
-    if (other.header.size < header.size || (data[header.size].abs & ~other.data[other.header.size].abs) != 0)
+    return subsumes(other, abstraction(), other.abstraction());
+}
+
+// As above, for any two clauses, given their abstractions:
+inline Lit Clause::subsumes(const Clause& other, uint32_t abst, uint32_t other_abst) const
+{
+    if (other.header.size < header.size || (abst & ~other_abst) != 0)
         return lit_Error;
 
     Lit        ret = lit_Undef;
@@ -452,7 +675,8 @@ ok:;
 inline void Clause::strengthen(Lit p)
 {
     remove(*this, p);
-    calcAbstraction();
+    if (learnt()) fingerprint(fingerprint() - litHash(p));
+    else          calcAbstraction();
 }
 
 //=================================================================================================
@@ -0,0 +1,245 @@
+/*************************************************************************************[Vivifier.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include "mtl/Sort.h"
+#include "core/Vivifier.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+// Snapshot:
+
+
+Vivifier::Vivifier() :
+    jobs(0), propagations(0), strengthened(0), redundant(0)
+  , base_clauses(-1), base_lits(0)
+  , qhead(0), skip(-1)
+  , job_propagations(0), job_strengthened(0), job_redundant(0)
+  , finished(false), cancel(false), running(false)
+{}
+
+
+Vivifier::~Vivifier()
+{
+    if (running){
+        cancel.store(true);
+        worker.join(); }
+}
+
+
+void Vivifier::clear(int nvars)
+{
+    assert(!running);
+    if (hasBase()){
+        clauses.shrink(clauses.size() - base_clauses);
+        lits   .shrink(lits.size() - base_lits);
+    }else{
+        clauses.clear();
+        lits   .clear(); }
+    targets.clear();
+    units  .clear();
+    assigns.clear();
+    assigns.growTo(nvars, l_Undef);
+}
+
+
+void Vivifier::setBase()
+{
+    assert(targets.size() == 0);
+    base_clauses = clauses.size();
+    base_lits    = lits.size();
+}
+
+
+void Vivifier::add(const Lit* ps, int size, bool target, uint64_t fp)
+{
+    assert(!running && size > 1);
+    ClauseInfo c = { lits.size(), size, fp, false };
+    for (int i = 0; i < size; i++)
+        lits.push(ps[i]);
+    if (target) targets.push(clauses.size());
+    clauses.push(c);
+}
+
+
+//=================================================================================================
+// Job:
+
+
+void Vivifier::start()
+{
+    assert(!running);
+    results    .clear();
+    result_lits.clear();
+    finished.store(false);
+    cancel  .store(false);
+    running = true;
+    job_propagations = job_strengthened = job_redundant = 0;
+    worker = std::thread(&Vivifier::run, this);
+}
+
+
+void Vivifier::collect()
+{
+    assert(running);
+    worker.join();
+    running = false;
+    jobs++;
+    propagations += job_propagations;
+    strengthened += job_strengthened;
+    redundant    += job_redundant;
+}
+
+
+bool Vivifier::propagate()
+{
+    while (qhead < trail.size()){
+        Lit            p  = trail[qhead++];     // 'p' is enqueued fact to propagate.
+        vec<Watch>&    ws = watches[toInt(~p)];
+        Watch          *i, *j, *end;
+        job_propagations++;
+
+        for (i = j = (Watch*)ws, end = i + ws.size(); i != end;){
+            // Try to avoid inspecting the clause:
+            if (value(i->blocker) == l_True){
+                *j++ = *i++; continue; }
+
+            const ClauseInfo& ci = clauses[i->cls];
+            if (i->cls == skip || ci.dead){
+                *j++ = *i++; continue; }
+
+            // Make sure the false literal is c[1]:
+            Lit* c         = &lits[ci.start];
+            Lit  false_lit = ~p;
+            if (c[0] == false_lit)
+                c[0] = c[1], c[1] = false_lit;
+
+            // If 0th watch is true, then clause is already satisfied.
+            Lit   first = c[0];
+            Watch w     = { i->cls, first };
+            if (first != i->blocker && value(first) == l_True){
+                *j++ = w; i++; continue; }
+
+            // Look for new watch:
+            int k = 2;
+            while (k < ci.size && value(c[k]) == l_False) k++;
+            if (k < ci.size){
+                c[1] = c[k]; c[k] = false_lit;
+                watches[toInt(c[1])].push(w);
+                i++; continue; }
+
+            // Did not find watch -- clause is unit under assignment:
+            *j++ = w; i++;
+            if (value(first) == l_False){
+                while (i < end)
+                    *j++ = *i++;
+                ws.shrink(i - j);
+                qhead = trail.size();
+                return false; }
+            assign(first);
+        }
+        ws.shrink(i - j);
+    }
+    return true;
+}
+
+
+void Vivifier::backtrack(int trail_size)
+{
+    for (int i = trail.size() - 1; i >= trail_size; i--)
+        assigns[var(trail[i])] = l_Undef;
+    trail.shrink(trail.size() - trail_size);
+    qhead = trail_size;
+}
+
+
+// Assigns the literals of the target one by one to false and propagates. The literals assigned so
+// far imply the target once a conflict occurs or a literal turns out true; a literal that turns out
+// false can be dropped by resolution with the target.
+void Vivifier::vivify(int cls)
+{
+    const ClauseInfo& ci = clauses[cls];
+    const Lit*        c  = &lits[ci.start];
+    for (int i = 0; i < ci.size; i++)
+        if (value(c[i]) == l_True) return;      // Satisfied at level 0.
+
+    int  trail_size = trail.size();
+    bool implied    = false;
+    kept.clear();
+    skip = cls;
+    for (int i = 0; i < ci.size && !implied; i++){
+        Lit p = c[i];
+        if (value(p) == l_False) continue;
+        kept.push(p);
+        if (value(p) == l_True)
+            implied = true;
+        else{
+            assign(~p);
+            implied = !propagate(); }
+    }
+    backtrack(trail_size);
+    skip = -1;
+    if (kept.size() == 0) return;               // Falsified at level 0; the search thread will notice.
+
+    Result r = { ci.fp, result_lits.size(), kept.size() };
+    if (kept.size() < ci.size){
+        for (int i = 0; i < kept.size(); i++)
+            result_lits.push(kept[i]);
+        results.push(r);
+        job_strengthened++;
+    }else if (implied){
+        // The rest of the snapshot implies the target, so later proofs must not rely on it:
+        clauses[cls].dead = true;
+        r.size = 0;
+        results.push(r);
+        job_redundant++; }
+}
+
+
+struct ResultFp_lt {
+    bool operator () (const Vivifier::Result& x, const Vivifier::Result& y) const { return x.fp < y.fp; }
+};
+
+void Vivifier::run()
+{
+    // Watch the first two literals of every clause, and propagate the units:
+    watches.clear();
+    watches.growTo(2 * assigns.size());
+    for (int i = 0; i < clauses.size(); i++){
+        clauses[i].dead = false;
+        const Lit* c = &lits[clauses[i].start];
+        Watch w0 = { i, c[1] }, w1 = { i, c[0] };
+        watches[toInt(c[0])].push(w0);
+        watches[toInt(c[1])].push(w1); }
+
+    trail.clear();
+    qhead = 0;
+    skip  = -1;
+    bool ok = true;
+    for (int i = 0; i < units.size() && ok; i++)
+        if      (value(units[i]) == l_False) ok = false;
+        else if (value(units[i]) == l_Undef) assign(units[i]);
+    ok = ok && propagate();
+
+    for (int i = 0; i < targets.size() && ok && !cancel.load(std::memory_order_relaxed); i++)
+        vivify(targets[i]);
+    sort(results, ResultFp_lt());
+
+    // Leave the assignment as found:
+    backtrack(0);
+    finished.store(true, std::memory_order_release);
+}
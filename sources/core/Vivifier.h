@@ -0,0 +1,120 @@
+/**************************************************************************************[Vivifier.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_Vivifier_h
+#define Minisat_Vivifier_h
+
+#include <atomic>
+#include <thread>
+
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Vivifier -- vivifies learnt clauses on a helper thread:
+//
+// The search thread fills in a snapshot: the level 0 units, a set of clauses implied by the formula
+// and, among them, the targets to vivify. The helper thread then propagates the negation of each
+// target literal by literal over the rest of the snapshot, with its own trail and assignment, and
+// records every target that it can shorten or that the rest of the snapshot implies. Apart from
+// the two flags, nothing is shared while a job runs; the search thread collects the results when
+// the job is done and finds the clauses they belong to by fingerprint.
+//
+// Clauses added before 'setBase()' (the original clauses) stay in the snapshot from job to job.
+
+class Vivifier {
+public:
+    struct Result {
+        uint64_t fp;            // Fingerprint of the target.
+        int      start;         // First literal of the shortened target in 'result_lits'.
+        int      size;          // Size of the shortened target, or 0 if the target is redundant.
+    };
+
+    vec<Result>  results;       // Sorted by fingerprint.
+    vec<Lit>     result_lits;
+
+    // Statistics (of the collected jobs):
+    uint64_t     jobs, propagations, strengthened, redundant;
+
+    Vivifier();
+   ~Vivifier();
+
+    bool     busy     () const { return running; }   // A job was started and its results not collected.
+    bool     done     () const { return running && finished.load(std::memory_order_acquire); }
+
+    // Building a snapshot (only while not busy):
+    void     clear    (int nvars);                   // Keeps the clauses added before 'setBase()'.
+    bool     hasBase  () const { return base_clauses >= 0; }
+    void     setBase  ();
+    void     dropBase () { assert(!running); base_clauses = -1; }   // The next 'clear()' drops the clauses added before 'setBase()' too.
+    void     addUnit  (Lit p)                            { units.push(p); }
+    void     addClause(const Lit* ps, int size)          { add(ps, size, false, 0); }
+    void     addTarget(const Lit* ps, int size, uint64_t fp) { add(ps, size, true, fp); }
+
+    void     start    ();                            // Starts vivifying the targets.
+    void     collect  ();                            // Waits for the job; the results are valid afterwards.
+
+private:
+    struct ClauseInfo {
+        int      start;
+        int      size;
+        uint64_t fp;
+        bool     dead;          // Implied by the rest of the snapshot; not used for propagation.
+    };
+    struct Watch {
+        int      cls;
+        Lit      blocker;
+    };
+
+    vec<Lit>          lits;
+    vec<ClauseInfo>   clauses;
+    vec<int>          targets;
+    vec<Lit>          units;
+    int               base_clauses, base_lits;
+
+    vec<vec<Watch> >  watches;          // Clauses watching each literal.
+    vec<lbool>        assigns;
+    vec<Lit>          trail;
+    vec<Lit>          kept;
+    int               qhead;
+    int               skip;             // The target being vivified, which must not propagate.
+    uint64_t          job_propagations, job_strengthened, job_redundant;
+
+    std::thread       worker;
+    std::atomic<bool> finished;
+    std::atomic<bool> cancel;
+    bool              running;
+
+    lbool    value    (Lit p) const { return assigns[var(p)] ^ sign(p); }
+    void     assign   (Lit p)       { assigns[var(p)] = lbool(!sign(p)); trail.push(p); }
+    void     add      (const Lit* ps, int size, bool target, uint64_t fp);
+    bool     propagate();                            // FALSE if a conflict was found.
+    void     backtrack(int trail_size);
+    void     vivify   (int cls);
+    void     run      ();
+
+    // Don't allow copying (error prone):
+    Vivifier&  operator = (Vivifier& other) { assert(0); return *this; }
+               Vivifier   (Vivifier& other) { assert(0); }
+};
+
+//=================================================================================================
+}
+
+#endif
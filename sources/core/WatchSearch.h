@@ -0,0 +1,97 @@
+/***********************************************************************************[WatchSearch.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_WatchSearch_h
+#define Minisat_WatchSearch_h
+
+#include "core/SolverTypes.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WIDE_WATCH_SEARCH
+#include <immintrin.h>
+#endif
+
+namespace Minisat {
+
+//=================================================================================================
+// Replacement watch search:
+//
+// When both the blocker and the other watch fail, 'propagate()' scans 'c[2..size)' for a literal
+// that is not false. On long clauses this scan dominates, so it gathers the values of 8 literals per
+// step (AVX2) straight out of 'lit_assigns'. The kernel is picked once from what the CPU supports.
+// Each gather reads 4 bytes at 'lit_assigns + lit', hence the padding kept in 'newVar()'. The
+// kernels, including a 16-wide AVX-512 one, are compared in 'bench/WatchSearch.cc'.
+
+typedef int (*FindWatchFn)(const Lit*, int, int, const lbool*);
+
+
+// Returns the index of the first literal in 'lits[from..size)' that is not false, or 'size'.
+static inline int findWatchScalar(const Lit* lits, int from, int size, const lbool* lit_assigns)
+{
+    for (; from < size; from++)
+        if (lit_assigns[toInt(lits[from])] != l_False)
+            break;
+    return from;
+}
+
+#ifdef WIDE_WATCH_SEARCH
+// An 'lbool' is a single byte and 'lit_assigns' only holds 0/1/2 for true/false/undef, so a literal
+// is false exactly when the low byte of its gathered word is 1.
+__attribute__((target("avx2")))
+static inline int findWatchAVX2(const Lit* lits, int from, int size, const lbool* lit_assigns)
+{
+    const __m256i one  = _mm256_set1_epi32(1);
+    const __m256i byte = _mm256_set1_epi32(0xff);
+    for (; from + 8 <= size; from += 8){
+        __m256i x   = _mm256_loadu_si256((const __m256i*)(lits + from));
+        __m256i val = _mm256_and_si256(_mm256_i32gather_epi32((const int*)lit_assigns, x, 1), byte);
+        unsigned mask = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(val, one))) & 0xff;
+        if (mask) return from + __builtin_ctz(mask); }
+    return findWatchScalar(lits, from, size, lit_assigns);
+}
+
+__attribute__((target("avx512f")))
+static inline int findWatchAVX512(const Lit* lits, int from, int size, const lbool* lit_assigns)
+{
+    const __m512i one  = _mm512_set1_epi32(1);
+    const __m512i byte = _mm512_set1_epi32(0xff);
+    const __m512i zero = _mm512_setzero_si512();
+    for (; from + 16 <= size; from += 16){
+        __m512i x   = _mm512_loadu_si512((const void*)(lits + from));
+        __m512i val = _mm512_and_si512(_mm512_mask_i32gather_epi32(zero, 0xffff, x, (const void*)lit_assigns, 1), byte);
+        __mmask16 mask = _mm512_cmpneq_epi32_mask(val, one);
+        if (mask) return from + __builtin_ctz(mask); }
+    return findWatchAVX2(lits, from, size, lit_assigns);
+}
+#endif
+
+
+// The AVX-512 kernel is not picked: it only came out ahead around 24 literals, and was no faster than
+// AVX2 at 64 and 128.
+static inline FindWatchFn selectFindWatch()
+{
+#ifdef WIDE_WATCH_SEARCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return findWatchAVX2;
+#endif
+    return findWatchScalar;
+}
+
+//=================================================================================================
+}
+
+#endif
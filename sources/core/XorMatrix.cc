@@ -0,0 +1,224 @@
+/************************************************************************************[XorMatrix.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include <algorithm>
+
+#include "core/XorMatrix.h"
+#include "core/Solver.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+// Setup:
+
+
+XorMatrix::XorMatrix(Solver& s, const vec<Var>& vars) :
+    solver(s)
+  , words((vars.size() + 63) >> 6)
+{
+    vars.copyTo(col_var);
+}
+
+
+void XorMatrix::addRow(const vec<int>& cols, bool r)
+{
+    int start = bits.size();
+    bits.growTo(start + words, 0);
+    for (int i = 0; i < cols.size(); i++)
+        bits[start + (cols[i] >> 6)] ^= bit(cols[i]);
+    rhs.push(r);
+}
+
+
+bool XorMatrix::init()
+{
+    int rows = nRows(), rank = 0;
+    for (int c = 0; c < nCols() && rank < rows; c++){
+        int      w = c >> 6;
+        uint64_t b = bit(c);
+        int      r = rank;
+        while (r < rows && !(row(r)[w] & b)) r++;
+        if (r == rows) continue;
+
+        if (r != rank){
+            for (int k = 0; k < words; k++)
+                std::swap(row(r)[k], row(rank)[k]);
+            std::swap(rhs[r], rhs[rank]); }
+        const uint64_t* p = row(rank);
+        for (r = 0; r < rows; r++)
+            if (r != rank && (row(r)[w] & b)){
+                uint64_t* q = row(r);
+                for (int k = 0; k < words; k++)
+                    q[k] ^= p[k];
+                rhs[r] ^= rhs[rank]; }
+        basic.push(c);
+        rank++; }
+
+    // The rows left over sum up to nothing now:
+    for (int r = rank; r < rows; r++)
+        if (rhs[r]) return false;
+    bits.shrink(bits.size() - rank * words);
+    rhs .shrink(rows - rank);
+
+    basic_row.growTo(nCols(), -1);
+    for (int r = 0; r < rank; r++)
+        basic_row[basic[r]] = r;
+    watch    .growTo(rank, -1);
+    watchers .growTo(nCols());
+    free_cols.growTo(words, ~(uint64_t)0);
+    true_cols.growTo(words, 0);
+
+    // A row of only its basic column is a unit:
+    for (int r = 0; r < rank; r++)
+        if (!rewatch(r) && propagateRow(r) != CRef_Undef)
+            return false;
+    return true;
+}
+
+
+//=================================================================================================
+// Propagation:
+
+
+void XorMatrix::setWatch(int r, int c)
+{
+    if (watch[r] != c){
+        watch[r] = c;
+        watchers[c].push(r); }
+}
+
+
+bool XorMatrix::rewatch(int r)
+{
+    const uint64_t* p  = row(r);
+    int             b  = basic[r];
+    int             bw = b >> 6;
+
+    // Look for an unassigned column from the current watch on, so that the watches spread out:
+    int start = watch[r] < 0 ? 0 : watch[r] >> 6;
+    for (int i = 0, k = start; i < words; i++, k = k + 1 < words ? k + 1 : 0){
+        uint64_t m = p[k] & free_cols[k];
+        if (k == bw) m &= ~bit(b);
+        if (m){
+            setWatch(r, (k << 6) + __builtin_ctzll(m));
+            return true; } }
+
+    // Every non-basic column is assigned. Watch the one of the highest level, which backtracking
+    // frees first (and whose level is the one of what the row implies):
+    int best = -1;
+    for (int k = 0; k < words; k++)
+        for (uint64_t m = k == bw ? p[k] & ~bit(b) : p[k]; m != 0; m &= m - 1){
+            int c = (k << 6) + __builtin_ctzll(m);
+            if (best < 0 || solver.level(col_var[c]) > solver.level(col_var[best]))
+                best = c; }
+    if (best >= 0) setWatch(r, best);
+    else           watch[r] = -1;
+    return false;
+}
+
+
+CRef XorMatrix::propagateRow(int r)
+{
+    const uint64_t* p = row(r);
+    int             b = basic[r];
+    int           par = rhs[r];
+    for (int k = 0; k < words; k++){
+        uint64_t m = k == (b >> 6) ? p[k] & ~bit(b) : p[k];
+        par ^= __builtin_popcountll(m & true_cols[k]) & 1; }
+
+    Lit q = mkLit(col_var[b], !par);    // (what the row makes of its basic column)
+    if (solver.value(q) == l_True)
+        return CRef_Undef;
+    if (solver.value(q) == l_False)
+        return solver.xorConflict(*this, p);
+    solver.xorEnqueue(q, watch[r] < 0 ? 0 : solver.level(col_var[watch[r]]), p, words);
+    return CRef_Undef;
+}
+
+
+CRef XorMatrix::pivot(int r, int c)
+{
+    basic_row[basic[r]] = -1;
+    basic[r]     = c;
+    basic_row[c] = r;
+
+    const uint64_t* p = row(r);
+    int             w = c >> 6;
+    uint64_t        b = bit(c);
+    touched.clear();
+    touched.push(r);
+    for (int r2 = 0; r2 < nRows(); r2++)
+        if (r2 != r && (row(r2)[w] & b)){
+            uint64_t* q = row(r2);
+            for (int k = 0; k < words; k++)
+                q[k] ^= p[k];
+            rhs[r2] ^= rhs[r];
+            touched.push(r2); }
+
+    // The watches of the changed rows may have dropped out of them. After a conflict, they are
+    // still put right, just not propagated:
+    CRef confl = CRef_Undef;
+    for (int i = 0; i < touched.size(); i++){
+        int r2 = touched[i], wc = watch[r2];
+        if (wc >= 0 && wc != basic[r2] && (row(r2)[wc >> 6] & free_cols[wc >> 6] & bit(wc)))
+            continue;
+        if (!rewatch(r2) && confl == CRef_Undef)
+            confl = propagateRow(r2); }
+    return confl;
+}
+
+
+CRef XorMatrix::assign(int c)
+{
+    int w = c >> 6;
+    free_cols[w] &= ~bit(c);
+    if (solver.value(col_var[c]) == l_True) true_cols[w] |=  bit(c);
+    else                                    true_cols[w] &= ~bit(c);
+
+    // The rows watching 'c' move on, or propagate:
+    CRef      confl = CRef_Undef;
+    vec<int>& ws    = watchers[c];
+    int       i, j;
+    for (i = j = 0; i < ws.size(); i++){
+        int r = ws[i];
+        if (watch[r] != c) continue;
+        if (!rewatch(r) && confl == CRef_Undef)
+            confl = propagateRow(r);
+        if (watch[r] == c)
+            ws[j++] = r; }
+    ws.shrink(i - j);
+    if (confl != CRef_Undef) return confl;
+
+    // The row of which 'c' is the basic column takes an unassigned one instead:
+    int r = basic_row[c];
+    if (r < 0) return CRef_Undef;
+    const uint64_t* p = row(r);
+    for (int k = 0; k < words; k++)
+        if (p[k] & free_cols[k])
+            return pivot(r, (k << 6) + __builtin_ctzll(p[k] & free_cols[k]));
+    return propagateRow(r);
+}
+
+
+void XorMatrix::explain(const uint64_t* p, vec<Lit>& out) const
+{
+    out.clear();
+    for (int k = 0; k < words; k++)
+        for (uint64_t m = p[k]; m != 0; m &= m - 1){
+            Var v = col_var[(k << 6) + __builtin_ctzll(m)];
+            out.push(mkLit(v, solver.value(v) == l_True)); }
+}
@@ -0,0 +1,90 @@
+/*************************************************************************************[XorMatrix.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_XorMatrix_h
+#define Minisat_XorMatrix_h
+
+#include <stdint.h>
+
+#include "mtl/Vec.h"
+#include "core/SolverTypes.h"
+
+namespace Minisat {
+
+class Solver;
+
+//=================================================================================================
+// XorMatrix -- a system of XOR constraints, propagated by Gauss-Jordan elimination:
+//
+// Each row is a bit-packed set of columns (variables) whose sum is the right-hand side. The rows are
+// kept in reduced form: every row has a basic column that no other row contains. Besides its basic
+// column, a row watches one non-basic column that is unassigned. When that one is assigned, the row
+// watches another; when there is none, the row implies its basic column (or conflicts). When the
+// basic column is assigned, an unassigned non-basic column takes its place, and is eliminated from
+// the other rows.
+//
+// Assignments are seen in the order of the trail of the solver, through 'assign()'. What a row
+// implies is reported to the solver with a copy of the row, from which the solver makes the reason
+// clause only if conflict analysis asks for it.
+
+class XorMatrix {
+public:
+    XorMatrix(Solver& s, const vec<Var>& vars);     // The columns, in order.
+
+    void     addRow   (const vec<int>& cols, bool rhs);
+    bool     init     ();                           // Eliminates at level 0. FALSE if the rows are inconsistent.
+
+    int      nRows    () const { return rhs.size(); }
+    int      nCols    () const { return col_var.size(); }
+    int      width    () const { return words; }    // Number of words of a row.
+
+    CRef     assign   (int c);                      // Column 'c' was assigned. Returns a conflicting clause, or 'CRef_Undef'.
+    void     unassign (int c) { free_cols[c >> 6] |= bit(c); }
+    void     explain  (const uint64_t* row, vec<Lit>& out) const; // The literals of a copy of a row that are false (or unassigned).
+
+private:
+    Solver&         solver;
+    vec<Var>        col_var;
+    int             words;
+    vec<uint64_t>   bits;           // Row 'r' is 'bits[r * words .. (r + 1) * words)'.
+    vec<char>       rhs;
+    vec<int>        basic;          // Per row: its basic column.
+    vec<int>        basic_row;      // Per column: the row it is basic in, or -1.
+    vec<int>        watch;          // Per row: the watched non-basic column, or -1 if the row has none.
+    vec<vec<int> >  watchers;       // Per column: the rows watching it (rows that moved on are dropped lazily).
+    vec<uint64_t>   free_cols;      // The columns 'assign()' has not seen assigned.
+    vec<uint64_t>   true_cols;      // Of the others, those assigned true.
+    vec<int>        touched;        // (temporary of 'pivot()')
+
+    static uint64_t bit(int c) { return (uint64_t)1 << (c & 63); }
+    uint64_t*       row(int r)       { return &bits[r * words]; }
+    const uint64_t* row(int r) const { return &bits[r * words]; }
+
+    void     setWatch (int r, int c);
+    bool     rewatch  (int r);                      // FALSE if every non-basic column of 'r' is assigned.
+    CRef     propagateRow(int r);                   // (every non-basic column of 'r' is assigned)
+    CRef     pivot    (int r, int c);               // Makes 'c' the basic column of 'r'.
+
+    // Don't allow copying (error prone):
+    XorMatrix& operator = (XorMatrix& other) { assert(0); return *this; }
+               XorMatrix  (XorMatrix& other) : solver(other.solver) { assert(0); }
+};
+
+//=================================================================================================
+}
+
+#endif
@@ -21,6 +21,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #ifndef Minisat_Alloc_h
 #define Minisat_Alloc_h
 
+#include <string.h>
+
 #include "mtl/XAlloc.h"
 #include "mtl/Vec.h"
 
@@ -28,6 +30,22 @@ namespace Minisat {
 
 //=================================================================================================
 // Simple Region-based memory allocator:
+//
+// References are 32-bit offsets counted in blocks of '1 << REGION_BLOCK_SHIFT' elements, and sizes
+// and capacities are counted in the same blocks. The default of one element per block can address
+// 2^32 elements (16 GiB of clauses). Every extra bit of shift doubles that, at the cost of padding
+// each allocation to a whole block, while references (and thus watchers) stay 32 bits wide. See
+// 'config.mk' for how to set it.
+//
+// Regions normally grow with 'xrealloc()', which may copy the whole region on every step. With
+// 'map_reserve' set, a region instead lives in a reserved range of address space that is committed
+// page by page as it fills ('xreserve()'), so it grows in place and is handed back to the system
+// as soon as it is dropped. A region only moves when it outgrows its reservation, into a new one
+// at least twice as large.
+
+#ifndef REGION_BLOCK_SHIFT
+#define REGION_BLOCK_SHIFT 0
+#endif
 
 template<class T>
 class RegionAllocator
@@ -36,52 +54,62 @@ class RegionAllocator
     uint32_t  sz;
     uint32_t  cap;
     uint32_t  wasted_;
+    size_t    reserved; // Bytes reserved for 'memory' by 'xreserve()' (0 if it comes from 'xrealloc()').
 
     void capacity(uint32_t min_cap);
+    void release () { if (reserved > 0) xrelease(memory, reserved); else if (memory != NULL) ::free(memory); }
+
+    static uint32_t blocks (int size)   { return ((uint32_t)size + Block_Mask) >> Block_Shift; }
+    static size_t   offset (uint32_t r) { return (size_t)r << Block_Shift; }
 
  public:
     // TODO: make this a class for better type-checking?
     typedef uint32_t Ref;
     enum { Ref_Undef = UINT32_MAX };
-    enum { Unit_Size = sizeof(uint32_t) };
+    enum { Block_Shift = REGION_BLOCK_SHIFT, Block_Mask = (1 << REGION_BLOCK_SHIFT) - 1 };
+    enum { Unit_Size = sizeof(uint32_t) << REGION_BLOCK_SHIFT };
 
-    explicit RegionAllocator(uint32_t start_cap = 1024*1024) : memory(NULL), sz(0), cap(0), wasted_(0){ capacity(start_cap); }
-    ~RegionAllocator()
-    {
-        if (memory != NULL)
-            ::free(memory);
-    }
+    static size_t map_reserve; // Bytes of address space to reserve per region (0 = grow with 'xrealloc()').
+    static bool   map_huge;    // Back reserved regions with huge pages if possible.
+
+    explicit RegionAllocator(uint32_t start_cap = 1024*1024) : memory(NULL), sz(0), cap(0), wasted_(0), reserved(0){ capacity(start_cap); }
+    ~RegionAllocator() { release(); }
 
 
     uint32_t size      () const      { return sz; }
     uint32_t wasted    () const      { return wasted_; }
 
     Ref      alloc     (int size); 
-    void     free      (int size)    { wasted_ += size; }
+    void     free      (int size)    { wasted_ += blocks(size); }
 
     // Deref, Load Effective Address (LEA), Inverse of LEA (AEL):
-    T&       operator[](Ref r)       { assert(r >= 0 && r < sz); return memory[r]; }
-    const T& operator[](Ref r) const { assert(r >= 0 && r < sz); return memory[r]; }
+    T&       operator[](Ref r)       { assert(r >= 0 && r < sz); return memory[offset(r)]; }
+    const T& operator[](Ref r) const { assert(r >= 0 && r < sz); return memory[offset(r)]; }
 
-    T*       lea       (Ref r)       { assert(r >= 0 && r < sz); return &memory[r]; }
-    const T* lea       (Ref r) const { assert(r >= 0 && r < sz); return &memory[r]; }
-    Ref      ael       (const T* t)  { assert((void*)t >= (void*)&memory[0] && (void*)t < (void*)&memory[sz-1]);
-        return  (Ref)(t - &memory[0]); }
+    T*       lea       (Ref r)       { assert(r >= 0 && r < sz); return &memory[offset(r)]; }
+    const T* lea       (Ref r) const { assert(r >= 0 && r < sz); return &memory[offset(r)]; }
+    Ref      ael       (const T* t)  { assert((void*)t >= (void*)&memory[0] && (void*)t < (void*)&memory[offset(sz)]);
+        return  (Ref)((size_t)(t - &memory[0]) >> Block_Shift); }
 
     void     moveTo(RegionAllocator& to) {
-        if (to.memory != NULL) ::free(to.memory);
+        to.release();
         to.memory = memory;
         to.sz = sz;
         to.cap = cap;
         to.wasted_ = wasted_;
+        to.reserved = reserved;
 
         memory = NULL;
         sz = cap = wasted_ = 0;
+        reserved = 0;
     }
 
 
 };
 
+template<class T> size_t RegionAllocator<T>::map_reserve = 0;
+template<class T> bool   RegionAllocator<T>::map_huge    = false;
+
 template<class T>
 void RegionAllocator<T>::capacity(uint32_t min_cap)
 {
@@ -102,7 +130,30 @@ void RegionAllocator<T>::capacity(uint32_t min_cap)
     // printf(" .. (%p) cap = %u\n", this, cap);
 
     assert(cap > 0);
-    memory = (T*)xrealloc(memory, sizeof(T)*cap);
+    size_t bytes = sizeof(T)*offset(cap);
+    if (bytes <= reserved) return;
+
+    if (map_reserve > 0){
+        size_t res = map_reserve > 2*reserved ? map_reserve : 2*reserved;
+        if (res < bytes) res = bytes;
+        T* mem = (T*)xreserve(res, map_huge);    // (may round 'res' up)
+        if (mem != NULL){
+            if (memory != NULL) memcpy(mem, memory, sizeof(T)*offset(sz));
+            release();
+            memory   = mem;
+            reserved = res;
+            return; }
+    }
+
+    if (reserved > 0){
+        // Could not reserve a larger range; continue on the heap.
+        T* mem = (T*)xrealloc(NULL, bytes);
+        memcpy(mem, memory, sizeof(T)*offset(sz));
+        release();
+        memory   = mem;
+        reserved = 0;
+    }else
+        memory = (T*)xrealloc(memory, bytes);
 }
 
 
@@ -112,10 +163,11 @@ RegionAllocator<T>::alloc(int size)
 { 
     // printf("ALLOC called (this = %p, size = %d)\n", this, size); fflush(stdout);
     assert(size > 0);
-    capacity(sz + size);
+    uint32_t n = blocks(size);
+    capacity(sz + n);
 
     uint32_t prev_sz = sz;
-    sz += size;
+    sz += n;
     
     // Handle overflow:
     if (sz < prev_sz)
@@ -27,18 +27,25 @@ namespace Minisat {
 
 //=================================================================================================
 // A heap implementation with support for decrease/increase key.
+//
+// The heap is d-ary, where the arity is a power of two chosen at construction. The root is stored
+// at index 'd-1', which puts the children of every node at 'd*(i-d+2)', a multiple of 'd'. With
+// 4-byte elements, a 4-ary heap thus finds all children of a node within one 16-byte group and
+// never across a cache line, and needs half the levels of a binary heap.
 
 
 template<class Comp>
 class Heap {
     Comp     lt;       // The heap is a minimum-heap with respect to this comparator
-    vec<int> heap;     // Heap of integers
-    vec<int> indices;  // Each integers position (index) in the Heap
+    vec<int> heap;     // Heap of integers, preceded by 'arity-1' unused slots
+    vec<int> indices;  // Each integers position (index) in 'heap'
+    int      arity;    // Number of children per node (a power of two)
+    int      shift;    // log2(arity)
 
     // Index "traversal" functions
-    static inline int left  (int i) { return i*2+1; }
-    static inline int right (int i) { return (i+1)*2; }
-    static inline int parent(int i) { return (i-1) >> 1; }
+    inline int root  ()      const { return arity-1; }
+    inline int child (int i) const { return (i - arity + 2) << shift; }     // (first child)
+    inline int parent(int i) const { return (i >> shift) + arity - 2; }
 
 
     void percolateUp(int i)
@@ -46,7 +53,7 @@ class Heap {
         int x  = heap[i];
         int p  = parent(i);
         
-        while (i != 0 && lt(x, heap[p])){
+        while (i != root() && lt(x, heap[p])){
             heap[i]          = heap[p];
             indices[heap[p]] = i;
             i                = p;
@@ -60,12 +67,16 @@ class Heap {
     void percolateDown(int i)
     {
         int x = heap[i];
-        while (left(i) < heap.size()){
-            int child = right(i) < heap.size() && lt(heap[right(i)], heap[left(i)]) ? right(i) : left(i);
-            if (!lt(heap[child], x)) break;
-            heap[i]          = heap[child];
+        while (child(i) < heap.size()){
+            int first = child(i);
+            int last  = first + arity < heap.size() ? first + arity : heap.size();
+            int min   = first;
+            for (int c = first+1; c < last; c++)
+                if (lt(heap[c], heap[min])) min = c;
+            if (!lt(heap[min], x)) break;
+            heap[i]          = heap[min];
             indices[heap[i]] = i;
-            i                = child;
+            i                = min;
         }
         heap   [i] = x;
         indices[x] = i;
@@ -73,12 +84,16 @@ class Heap {
 
 
   public:
-    Heap(const Comp& c) : lt(c) { }
-
-    int  size      ()          const { return heap.size(); }
-    bool empty     ()          const { return heap.size() == 0; }
+    // An arity that is not a power of two is rounded down to one:
+    Heap(const Comp& c, int d = 2) : lt(c), shift(1) {
+        while ((2 << shift) <= d) shift++;
+        arity = 1 << shift;
+        heap.growTo(root(), -1); }
+
+    int  size      ()          const { return heap.size() - root(); }
+    bool empty     ()          const { return size() == 0; }
     bool inHeap    (int n)     const { return n < indices.size() && indices[n] >= 0; }
-    int  operator[](int index) const { assert(index < heap.size()); return heap[index]; }
+    int  operator[](int index) const { assert(index < size()); return heap[index + root()]; }
 
 
     void decrease  (int n) { assert(inHeap(n)); percolateUp  (indices[n]); }
@@ -109,35 +124,38 @@ class Heap {
 
     int  removeMin()
     {
-        int x            = heap[0];
-        heap[0]          = heap.last();
-        indices[heap[0]] = 0;
+        int x            = heap[root()];
+        heap[root()]     = heap.last();
+        indices[heap[root()]] = root();
         indices[x]       = -1;
         heap.pop();
-        if (heap.size() > 1) percolateDown(0);
+        if (size() > 1) percolateDown(root());
         return x; 
     }
 
 
     // Rebuild the heap from scratch, using the elements in 'ns':
     void build(const vec<int>& ns) {
-        for (int i = 0; i < heap.size(); i++)
-            indices[heap[i]] = -1;
-        heap.clear();
+        clear();
 
         for (int i = 0; i < ns.size(); i++){
-            indices[ns[i]] = i;
+            indices.growTo(ns[i]+1, -1);
+            indices[ns[i]] = heap.size();
             heap.push(ns[i]); }
 
-        for (int i = heap.size() / 2 - 1; i >= 0; i--)
-            percolateDown(i);
+        for (int i = heap.size() - 1; i >= root(); i--)
+            if (child(i) < heap.size())
+                percolateDown(i);
     }
 
     void clear(bool dealloc = false) 
     { 
-        for (int i = 0; i < heap.size(); i++)
+        for (int i = root(); i < heap.size(); i++)
             indices[heap[i]] = -1;
-        heap.clear(dealloc); 
+        heap.shrink(size());
+        if (dealloc){
+            heap.clear(true);
+            heap.growTo(root(), -1); }
     }
 };
 
@@ -0,0 +1,228 @@
+/******************************************************************************************[Pool.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_Pool_h
+#define Minisat_Pool_h
+
+#include <string.h>
+
+#include "mtl/XAlloc.h"
+#include "mtl/Vec.h"
+
+namespace Minisat {
+
+//=================================================================================================
+// Pooled storage for large numbers of small vectors:
+//
+// A 'VecPool' carves blocks with a power-of-two capacity out of big slabs and keeps one free list
+// per size class, so that millions of short vectors cost neither a 'malloc()' each nor the
+// fragmentation that comes with it. Slabs never move, so a vector of the pool stays put while
+// others grow. Vectors that outgrow the largest class are allocated on their own with 'realloc()',
+// like a 'vec'. Between 'beginCompact()' and 'endCompact()' every vector of the pool must be
+// moved with 'PoolVec::compact()'; this lays them out again in fresh slabs in the order they are
+// visited and gives the old slabs back.
+//
+// NOTE! Like 'vec', only for datatypes that can be relocated in memory.
+
+template<class T>
+class VecPool {
+public:
+    enum { Min_Cap = 4, Max_Cap = 1 << 12, Slab_Cap = 1 << 16 };
+
+private:
+    enum { Min_Shift = 2, Classes = 11 };   // Capacities 2^Min_Shift .. Max_Cap.
+
+    struct FreeBlock { FreeBlock* next; };
+
+    vec<T*>     slabs;
+    vec<T*>     old_slabs;         // Slabs still referenced by vectors during a compaction.
+    FreeBlock*  free_list[Classes];
+    T*          top;               // Unused tail of the most recent slab.
+    int         left;
+
+    static int  classOf(int cap) { int c = 0; while ((Min_Cap << c) < cap) c++; return c; }
+
+    void push(T* block, int c) {
+        FreeBlock* b = (FreeBlock*)block;
+        b->next      = free_list[c];
+        free_list[c] = b; }
+
+    void newSlab() {
+        // Hand the tail of the old slab out to the smaller classes before moving on:
+        for (int c = Classes-1; c >= 0; c--)
+            while (left >= (Min_Cap << c)){
+                push(top, c);
+                top  += Min_Cap << c;
+                left -= Min_Cap << c; }
+        T* slab = (T*)xrealloc(NULL, Slab_Cap * sizeof(T));
+        slabs.push(slab);
+        top  = slab;
+        left = Slab_Cap; }
+
+    void reset() {
+        for (int c = 0; c < Classes; c++) free_list[c] = NULL;
+        top  = NULL;
+        left = 0; }
+
+    static void freeSlabs(vec<T*>& ss) {
+        for (int i = 0; i < ss.size(); i++) ::free(ss[i]);
+        ss.clear(true); }
+
+    // Don't allow copying (error prone):
+    VecPool&  operator = (VecPool& other) { assert(0); return *this; }
+              VecPool    (VecPool& other) { assert(0); }
+
+public:
+    VecPool() { reset(); }
+   ~VecPool() { freeSlabs(slabs); freeSlabs(old_slabs); }
+
+    // Capacity of the class a vector of 'size' elements goes in (0 if too large for the pool):
+    static int  fit(int size) { if (size > Max_Cap) return 0; int cap = Min_Cap; while (cap < size) cap <<= 1; return cap; }
+
+    T*   alloc(int cap) {
+        assert(cap == fit(cap));
+        int c = classOf(cap);
+        if (free_list[c] != NULL){
+            T* block     = (T*)free_list[c];
+            free_list[c] = free_list[c]->next;
+            return block; }
+        if (left < cap) newSlab();
+        T* block = top;
+        top  += cap;
+        left -= cap;
+        return block; }
+
+    void free(T* block, int cap) { assert(cap == fit(cap)); push(block, classOf(cap)); }
+
+    void beginCompact() { assert(old_slabs.size() == 0); slabs.moveTo(old_slabs); reset(); }
+    void endCompact  () { freeSlabs(old_slabs); }
+
+    uint64_t bytes() const { return (uint64_t)slabs.size() * Slab_Cap * sizeof(T); }
+};
+
+
+//=================================================================================================
+// A vector with the interface of 'vec' whose storage comes from a 'VecPool':
+//
+// A vector that is not bound to a pool behaves like a plain 'vec'.
+
+template<class T>
+class PoolVec {
+    T*          data;
+    int         sz;
+    int         cap;
+    VecPool<T>* pool;
+
+    bool pooled() const { return pool != NULL && cap <= VecPool<T>::Max_Cap; }
+
+    void release() {
+        if (data == NULL) return;
+        if (pooled()) pool->free(data, cap);
+        else          ::free(data);
+        data = NULL, cap = 0; }
+
+    // Don't allow copying (error prone):
+    PoolVec<T>&  operator = (PoolVec<T>& other) { assert(0); return *this; }
+                 PoolVec    (PoolVec<T>& other) { assert(0); }
+
+public:
+    PoolVec() : data(NULL), sz(0), cap(0), pool(NULL) { }
+   ~PoolVec() { clear(true); }
+
+    void     bind     (VecPool<T>* p) { assert(data == NULL); pool = p; }
+
+    // Pointer to first element:
+    operator T*       (void)           { return data; }
+
+    // Size operations:
+    int      size     (void) const     { return sz; }
+    void     shrink   (int nelems)     { assert(nelems <= sz); for (int i = 0; i < nelems; i++) sz--, data[sz].~T(); }
+    void     shrink_  (int nelems)     { assert(nelems <= sz); sz -= nelems; }
+    int      capacity (void) const     { return cap; }
+    void     capacity (int min_cap);
+    void     clear    (bool dealloc = false) {
+        for (int i = 0; i < sz; i++) data[i].~T();
+        sz = 0;
+        if (dealloc) release(); }
+
+    // Stack interface:
+    void     push  (const T& elem)     { if (sz == cap) capacity(sz+1); data[sz++] = elem; }
+    void     push_ (const T& elem)     { assert(sz < cap); data[sz++] = elem; }
+    void     pop   (void)              { assert(sz > 0); sz--, data[sz].~T(); }
+
+    const T& last  (void) const        { return data[sz-1]; }
+    T&       last  (void)              { return data[sz-1]; }
+
+    // Vector interface:
+    const T& operator [] (int index) const { return data[index]; }
+    T&       operator [] (int index)       { return data[index]; }
+
+    // Moves the elements to the smallest block that holds them (see 'VecPool::beginCompact()'):
+    void     compact();
+};
+
+
+template<class T>
+void PoolVec<T>::capacity(int min_cap) {
+    if (cap >= min_cap) return;
+    int new_cap = pool != NULL ? VecPool<T>::fit(min_cap) : 0;
+    if (new_cap != 0){
+        // Next size class in the pool:
+        T* block = pool->alloc(new_cap);
+        if (sz > 0) memcpy(block, data, sz * sizeof(T));
+        if (data != NULL) pool->free(data, cap);
+        data = block;
+        cap  = new_cap;
+        return; }
+
+    // Too large for the pool (or unbound); grow by approximately 3/2 like 'vec':
+    int add = ((cap >> 1) + 2) & ~1;
+    if (add < min_cap - cap) add = (min_cap - cap + 1) & ~1;
+    if (add > INT_MAX - cap) throw OutOfMemoryException();
+    if (pooled()){
+        T* block = (T*)xrealloc(NULL, (cap + add) * sizeof(T));
+        if (sz > 0) memcpy(block, data, sz * sizeof(T));
+        if (data != NULL) pool->free(data, cap);
+        data = block;
+    }else
+        data = (T*)xrealloc(data, (cap + add) * sizeof(T));
+    cap += add;
+}
+
+
+template<class T>
+void PoolVec<T>::compact() {
+    if (pool == NULL || !pooled() && VecPool<T>::fit(sz) == 0) return;
+    T*  old      = data;
+    int old_cap  = cap;
+    if (sz == 0){
+        data = NULL;
+        cap  = 0;
+    }else{
+        cap  = VecPool<T>::fit(sz);
+        data = pool->alloc(cap);
+        memcpy(data, old, sz * sizeof(T)); }
+
+    // Blocks of the pool go back with their slab; a vector that shrank back into the pool frees its
+    // own allocation:
+    if (old != NULL && old_cap > VecPool<T>::Max_Cap) ::free(old);
+}
+
+//=================================================================================================
+}
+
+#endif
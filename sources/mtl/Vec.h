@@ -33,6 +33,8 @@ namespace Minisat {
 // Automatically resizable arrays
 //
 // NOTE! Don't use this vector on datatypes that cannot be re-located in memory (with realloc)
+//       Vectors of vectors can be, even though they are not trivially copyable, hence the cast to
+//       'void*' in 'capacity()' that keeps gcc from warning about them.
 
 template<class T>
 class vec {
@@ -96,7 +98,7 @@ template<class T>
 void vec<T>::capacity(int min_cap) {
     if (cap >= min_cap) return;
     int add = imax((min_cap - cap + 1) & ~1, ((cap >> 1) + 2) & ~1);   // NOTE: grow by approximately 3/2
-    if (add > INT_MAX - cap || ((data = (T*)::realloc(data, (cap += add) * sizeof(T))) == NULL) && errno == ENOMEM)
+    if (add > INT_MAX - cap || ((data = (T*)::realloc((void*)data, (cap += add) * sizeof(T))) == NULL) && errno == ENOMEM)
         throw OutOfMemoryException();
  }
 
@@ -22,7 +22,14 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define Minisat_XAlloc_h
 
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define XALLOC_HAS_MMAP
+#endif
 
 namespace Minisat {
 
@@ -39,6 +46,72 @@ static inline void* xrealloc(void *ptr, size_t size)
         return mem;
 }
 
+//=================================================================================================
+// Reserved address ranges (used by 'RegionAllocator'):
+//
+// 'xreserve()' maps 'size' bytes of anonymous memory without backing them, so pages are only
+// committed when first written. It returns NULL when no such range can be had (no 'mmap()', a
+// strict overcommit policy, or an address space limit), and the caller falls back to 'xrealloc()'.
+// With 'huge' it first tries a 'MAP_HUGETLB' mapping, whose pages the kernel takes from the huge
+// page pool up front (so a pool that is too small fails here instead of at first touch), and
+// otherwise asks for transparent huge pages. In that case 'size' is rounded up to a multiple of the
+// huge page size, as the kernel requires for unmapping, and 'size' returns the length mapped; the
+// range must be given back by 'xrelease()' with that length.
+
+#ifdef XALLOC_HAS_MMAP
+// The default huge page size, which 'MAP_HUGETLB' uses (2 MiB if the kernel does not say):
+static inline size_t xhugePageSize()
+{
+    static size_t huge_page = 0;
+    if (huge_page == 0){
+        huge_page = (size_t)2 << 20;
+        FILE* in = fopen("/proc/meminfo", "r");
+        if (in != NULL){
+            char          line[256];
+            unsigned long kb;
+            while (fgets(line, sizeof(line), in) != NULL)
+                if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb > 0){
+                    huge_page = (size_t)kb << 10;
+                    break; }
+            fclose(in); } }
+    return huge_page;
+}
+#endif
+
+static inline void* xreserve(size_t& size, bool huge)
+{
+#ifdef XALLOC_HAS_MMAP
+    if (huge){
+        size_t page = xhugePageSize();
+        size = (size + page - 1) / page * page; }
+#ifdef MAP_HUGETLB
+    if (huge){
+        void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED) return mem; }
+#endif
+    void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+    if (huge) madvise(mem, size, MADV_HUGEPAGE);
+#endif
+    return mem;
+#else
+    (void)size; (void)huge;
+    return NULL;
+#endif
+}
+
+static inline void xrelease(void* ptr, size_t size)
+{
+#ifdef XALLOC_HAS_MMAP
+    // A failure would leak the whole range, so it is not silent:
+    if (munmap(ptr, size) != 0)
+        fprintf(stderr, "c WARNING: could not unmap %zu bytes of a reserved region (%s)\n", size, strerror(errno));
+#else
+    (void)ptr; (void)size;
+#endif
+}
+
 //=================================================================================================
 }
 
@@ -4,3 +4,9 @@
 ##
 ##  CFLAGS += -I/usr/local/include
 ##  LFLAGS += -L/usr/local/lib
+##
+##  Clause references are 32-bit offsets, which by default limits original and learnt clauses
+##  to 8 GiB each. Each extra bit of REGION_BLOCK_SHIFT doubles that limit (e.g. 2 gives 32 GiB
+##  each), at the cost of rounding every clause up to a multiple of 2^shift words:
+##
+##  CFLAGS += -D REGION_BLOCK_SHIFT=2
@@ -31,8 +31,8 @@ LFLAGS    ?= -Wall
 
 COPTIMIZE ?= -O3
 
-CFLAGS    += -I$(MROOT) -D __STDC_LIMIT_MACROS -D __STDC_FORMAT_MACROS
-LFLAGS    += -lz
+CFLAGS    += -I$(MROOT) -D __STDC_LIMIT_MACROS -D __STDC_FORMAT_MACROS -pthread
+LFLAGS    += -lz -pthread
 
 # CFLAGS - Add include directory
 CFLAGS += -I$(HIREDIS_INCLUDE_DIR)
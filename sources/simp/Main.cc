@@ -39,6 +39,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "utils/ParseUtils.h"
 #include "utils/Options.h"
 #include "core/Dimacs.h"
+#include "core/Redis.h"
 #include "simp/SimpSolver.h"
 
 using namespace Minisat;
@@ -103,11 +104,28 @@ int main(int argc, char** argv)
         BoolOption   drup   ("MAIN", "drup",   "Generate DRUP UNSAT proof.", false);
         StringOption drup_file("MAIN", "drup-file", "DRUP UNSAT proof ouput file.", "");
 
+        IntOption     opt_max_clause_len    ("REDIS", "max-clause-len",  "Maximum length of the cloze that we save in redis",  10, IntRange(1, 100));
+        IntOption     opt_redis_buffer      ("REDIS", "redis-buffer",    "The maximum packet length in Redis",  5000, IntRange(100, 10000));
+        IntOption     opt_redis_port        ("REDIS", "redis-port",      "Redis port",  6379, IntRange(100, 10000));
+        StringOption  opt_redis_host        ("REDIS", "redis-host",      "Redis host",  "127.0.0.1");
+        IntOption     opt_redis_shared      ("REDIS", "redis-shared",    "Number of clause fingerprints remembered to skip clauses already saved or loaded",  1 << 20, IntRange(1, INT32_MAX/4));
+
         parseOptions(argc, argv, true);
         
         SimpSolver  S;
         double      initial_time = cpuTime();
 
+        Redis redis(S);
+        redis.redis_host = opt_redis_host;
+        redis.redis_port = opt_redis_port;
+        redis.redis_last_from_minisat_id = 0;
+        redis.redis_buffer = opt_redis_buffer;
+        redis.max_clause_len = opt_max_clause_len;
+        redis.shared.init(opt_redis_shared);
+        redis.units.clear();
+        redis.learnts.clear();
+        S.redis = &redis;
+
         if (!pre) S.eliminate(true);
 
         S.parsing = true;
@@ -177,6 +195,7 @@ int main(int argc, char** argv)
         signal(SIGXCPU,SIGINT_interrupt);
 
         S.parsing = false;
+        S.redis->flush_redis();
         S.eliminate(true);
         double simplified_time = cpuTime();
         if (S.verbosity > 0){
@@ -28,6 +28,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include "mtl/Sort.h"
 #include "simp/SimpSolver.h"
+#include "core/Redis.h"
 #include "utils/System.h"
 
 using namespace Minisat;
@@ -45,6 +46,10 @@ static IntOption    opt_grow             (_cat, "grow",         "Allow a variabl
 static IntOption    opt_clause_lim       (_cat, "cl-lim",       "Variables are not eliminated if it produces a resolvent with a length above this limit. -1 means no limit", 20,   IntRange(-1, INT32_MAX));
 static IntOption    opt_subsumption_lim  (_cat, "sub-lim",      "Do not check if subsumption against a clause larger than this. -1 means no limit.", 1000, IntRange(-1, INT32_MAX));
 static DoubleOption opt_simp_garbage_frac(_cat, "simp-gc-frac", "The fraction of wasted memory allowed before a garbage collection is triggered during simplification.",  0.5, DoubleRange(0, false, HUGE_VAL, false));
+static BoolOption   opt_use_inprocess    (_cat, "inprocess",    "Rerun variable elimination at restarts during search.", true);
+static DoubleOption opt_elim_effort      (_cat, "elim-effort",  "Work of a rerun of variable elimination, relative to the propagations of search since the last.", 1.0, DoubleRange(0, true, HUGE_VAL, false));
+static IntOption    opt_elim_interval    (_cat, "elim-interval","Conflicts before the first rerun of variable elimination; the gap grows by as much after each.", 10000, IntRange(1, INT32_MAX));
+static BoolOption   opt_use_gates        (_cat, "gates",        "Only resolve the clauses of a gate definition (AND, XOR, ITE) against the rest when eliminating.", true);
 
 
 //=================================================================================================
@@ -60,15 +65,26 @@ SimpSolver::SimpSolver() :
   , use_asymm          (opt_use_asymm)
   , use_rcheck         (opt_use_rcheck)
   , use_elim           (opt_use_elim)
+  , use_inprocess      (opt_use_inprocess)
+  , elim_effort        (opt_elim_effort)
+  , elim_interval      (opt_elim_interval)
+  , use_gates          (opt_use_gates)
   , merges             (0)
   , asymm_lits         (0)
   , eliminated_vars    (0)
+  , elim_rounds        (0)
+  , inpr_eliminated    (0)
+  , gates              (0)
   , elimorder          (1)
   , use_simplification (true)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (0)
   , n_touched          (0)
+  , elim_ticks         (0)
+  , elim_budget        (UINT64_MAX)
+  , elim_next          (opt_elim_interval)
+  , elim_props         (0)
 {
     vec<Lit> dummy(1,lit_Undef);
     ca.extra_clause_field = true; // NOTE: must happen before allocating the dummy clause below.
@@ -130,6 +146,8 @@ lbool SimpSolver::solve_(bool do_simp, bool turn_off_simp)
 
     if (result == l_True)
         extendModel();
+    if (verbosity >= 1 && elim_rounds > 0)
+        fprintf(stderr,"c Variable elimination during search: %d rounds, %d variables eliminated\n", elim_rounds, inpr_eliminated);
 
     if (do_simp)
         // Unfreeze the assumptions that were frozen:
@@ -153,9 +171,7 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
     if (use_rcheck && implied(ps))
         return true;
 
-    if (!Solver::addClause_(ps))
-        return false;
-
+    // Log the clause as given, which 'Solver::addClause_()' deletes again if it drops literals:
     if (!parsing && drup_file) {
 #ifdef BIN_DRUP
         binDRUP('a', ps, drup_file);
@@ -166,6 +182,9 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
 #endif
     }
 
+    if (!Solver::addClause_(ps))
+        return false;
+
     if (use_simplification && clauses.size() == nclauses + 1){
         CRef          cr = clauses.last();
         const Clause& c  = ca[cr];
@@ -244,6 +263,7 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
         detachClause(cr, true);
         c.strengthen(l);
         attachClause(cr);
+        original_changes++;
         remove(occurs[var(l)], cr);
         n_occ[toInt(l)]--;
         updateElimHeap(var(l));
@@ -262,6 +282,7 @@ bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& ou
     bool  ps_smallest = _ps.size() < _qs.size();
     const Clause& ps  =  ps_smallest ? _qs : _ps;
     const Clause& qs  =  ps_smallest ? _ps : _qs;
+    elim_ticks += ps.size() * qs.size();
 
     for (int i = 0; i < qs.size(); i++){
         if (var(qs[i]) != v){
@@ -294,6 +315,7 @@ bool SimpSolver::merge(const Clause& _ps, const Clause& _qs, Var v, int& size)
     const Clause& qs  =  ps_smallest ? _ps : _qs;
     const Lit*  __ps  = (const Lit*)ps;
     const Lit*  __qs  = (const Lit*)qs;
+    elim_ticks += ps.size() * qs.size();
 
     size = ps.size()-1;
 
@@ -372,8 +394,8 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
 
     while (subsumption_queue.size() > 0 || bwdsub_assigns < trail.size()){
 
-        // Empty subsumption queue and return immediately on user-interrupt:
-        if (asynch_interrupt){
+        // Empty subsumption queue and return immediately on user-interrupt or when out of budget:
+        if (asynch_interrupt || elim_ticks >= elim_budget){
             subsumption_queue.clear();
             bwdsub_assigns = trail.size();
             break; }
@@ -404,6 +426,7 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
         // Search all candidates:
         vec<CRef>& _cs = occurs.lookup(best);
         CRef*       cs = (CRef*)_cs;
+        elim_ticks += _cs.size();
 
         for (int j = 0; j < _cs.size(); j++)
             if (c.mark())
@@ -508,6 +531,90 @@ static void mkElimClause(vec<uint32_t>& elimclauses, Var v, Clause& c)
 
 
 
+// Looks for clauses among the occurrences of 'v' that define it, or its negation 'x', in terms of
+// other literals:
+//
+//   AND  x = a1 & ... & ak   (~x | a1) ... (~x | ak) (x | ~a1 | ... | ~ak)   (k = 1 is an equivalence)
+//   ITE  x = c ? t : e       (~x | ~c | t) (~x | c | e) (x | ~c | ~t) (x | c | ~e)   (e = ~t is a XOR)
+//
+// Marks the clauses of the first definition found in 'pos_gate' and 'neg_gate'. Resolving them
+// against each other only gives tautologies, and the resolvents of the other clauses among
+// themselves follow from the rest, so elimination only needs the resolvents between the two groups.
+bool SimpSolver::findGate(Var v, const vec<CRef>& pos, const vec<CRef>& neg, vec<char>& pos_gate, vec<char>& neg_gate)
+{
+    elim_ticks += pos.size() + neg.size();
+    gate_mark.growTo(nVars(), 0);
+    for (int s = 0; s < 2; s++){
+        Lit               x     = mkLit(v, s);
+        const vec<CRef>&  xs    = s ? neg : pos;        // Clauses with 'x',
+        const vec<CRef>&  nxs   = s ? pos : neg;        // and with '~x'.
+        vec<char>&        xg    = s ? neg_gate : pos_gate;
+        vec<char>&        nxg   = s ? pos_gate : neg_gate;
+
+        // AND: mark the literals that 'x' implies through a binary clause, then look for a clause
+        // with 'x' and only their negations:
+        for (int j = 0; j < nxs.size(); j++){
+            const Clause& c = ca[nxs[j]];
+            if (c.size() == 2){
+                Lit a = c[0] == ~x ? c[1] : c[0];
+                gate_mark[var(a)] |= 1 << sign(a); } }
+        int def = -1;
+        for (int i = 0; i < xs.size() && def == -1; i++){
+            const Clause& c = ca[xs[i]];
+            int k = 0;
+            while (k < c.size() && (c[k] == x || (gate_mark[var(c[k])] & (1 << !sign(c[k]))))) k++;
+            if (k == c.size()) def = i; }
+        for (int j = 0; j < nxs.size(); j++){
+            const Clause& c = ca[nxs[j]];
+            if (c.size() == 2) gate_mark[var(c[0])] = gate_mark[var(c[1])] = 0; }
+        if (def != -1){
+            const Clause& d = ca[xs[def]];
+            xg[def] = 1;
+            for (int j = 0; j < nxs.size(); j++){
+                const Clause& c = ca[nxs[j]];
+                if (c.size() == 2 && find(d, ~(c[0] == ~x ? c[1] : c[0]))) nxg[j] = 1; }
+            return true; }
+
+        // ITE: for each '(~x | ~c | t)', look for '(x | ~c | ~t)', then for each '(~x | c | e)' for
+        // '(x | c | ~e)':
+        for (int j1 = 0; j1 < nxs.size(); j1++){
+            const Clause& c1 = ca[nxs[j1]];
+            if (c1.size() != 3) continue;
+            for (int r = 0; r < 2; r++){
+                Lit o[2];
+                for (int k = 0, n = 0; k < 3; k++)
+                    if (c1[k] != ~x) o[n++] = c1[k];
+                Lit nc = o[r], t = o[1 - r];
+                int i1 = findTernary(xs, x, nc, ~t);
+                if (i1 == -1) continue;
+                for (int j2 = 0; j2 < nxs.size(); j2++){
+                    const Clause& c2 = ca[nxs[j2]];
+                    if (j2 == j1 || c2.size() != 3 || !find(c2, ~nc)) continue;
+                    Lit e = lit_Undef;
+                    for (int k = 0; k < 3; k++)
+                        if (c2[k] != ~x && c2[k] != ~nc) e = c2[k];
+                    int i2 = findTernary(xs, x, ~nc, ~e);
+                    if (i2 == -1) continue;
+                    nxg[j1] = nxg[j2] = xg[i1] = xg[i2] = 1;
+                    return true; }
+            }
+        }
+    }
+    return false;
+}
+
+
+// Index of the clause in 'cs' that consists of exactly 'a', 'b' and 'c', or -1.
+int SimpSolver::findTernary(const vec<CRef>& cs, Lit a, Lit b, Lit c)
+{
+    elim_ticks += cs.size();
+    for (int i = 0; i < cs.size(); i++){
+        const Clause& d = ca[cs[i]];
+        if (d.size() == 3 && find(d, a) && find(d, b) && find(d, c)) return i; }
+    return -1;
+}
+
+
 bool SimpSolver::eliminateVar(Var v)
 {
     assert(!frozen[v]);
@@ -521,6 +628,10 @@ bool SimpSolver::eliminateVar(Var v)
     for (int i = 0; i < cls.size(); i++)
         (find(ca[cls[i]], mkLit(v)) ? pos : neg).push(cls[i]);
 
+    // With a gate definition, only its clauses need to be resolved against the others:
+    vec<char> pos_gate(pos.size(), 0), neg_gate(neg.size(), 0);
+    bool      gate = use_gates && findGate(v, pos, neg, pos_gate, neg_gate);
+
     // Check wether the increase in number of clauses stays within the allowed ('grow'). Moreover, no
     // clause must exceed the limit on the maximal clause size (if it is set):
     //
@@ -529,7 +640,7 @@ bool SimpSolver::eliminateVar(Var v)
 
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, clause_size) && 
+            if ((!gate || pos_gate[i] != neg_gate[j]) && merge(ca[pos[i]], ca[neg[j]], v, clause_size) &&
                 (++cnt > cls.size() + grow || (clause_lim != -1 && clause_size > clause_lim)))
                 return true;
 
@@ -537,6 +648,7 @@ bool SimpSolver::eliminateVar(Var v)
     eliminated[v] = true;
     setDecisionVar(v, false);
     eliminated_vars++;
+    if (gate) gates++;
 
     if (pos.size() > neg.size()){
         for (int i = 0; i < neg.size(); i++)
@@ -552,7 +664,7 @@ bool SimpSolver::eliminateVar(Var v)
     vec<Lit>& resolvent = add_tmp;
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, resolvent) && !addClause_(resolvent))
+            if ((!gate || pos_gate[i] != neg_gate[j]) && merge(ca[pos[i]], ca[neg[j]], v, resolvent) && !addClause_(resolvent))
                 return false;
 
     for (int i = 0; i < cls.size(); i++)
@@ -561,11 +673,13 @@ bool SimpSolver::eliminateVar(Var v)
     // Free occurs list for this variable:
     occurs[v].clear(true);
     
-    // Free watchers lists for this variable, if possible:
-    watches_bin[ mkLit(v)].clear(true);
-    watches_bin[~mkLit(v)].clear(true);
-    watches[ mkLit(v)].clear(true);
-    watches[~mkLit(v)].clear(true);
+    // Free watchers lists for this variable, if possible (during search, learnt clauses may still
+    // watch it until 'removeEliminatedLearnts()'):
+    if (nLearnts() == 0){
+        watches_bin[ mkLit(v)].clear(true);
+        watches_bin[~mkLit(v)].clear(true);
+        watches[ mkLit(v)].clear(true);
+        watches[~mkLit(v)].clear(true); }
 
     return backwardSubsumptionCheck();
 }
@@ -641,8 +755,12 @@ bool SimpSolver::eliminate(bool turn_off_elim)
     bool res = true;
     int iter = 0;
     int n_cls, n_cls_init, n_vars;
+    int grow_init = grow;
+    elim_budget = UINT64_MAX;
 
-    if (nVars() == 0) goto cleanup; // User disabling preprocessing.
+    if (nVars() == 0){ // User disabling preprocessing.
+        use_inprocess = false;
+        goto cleanup; }
 
     // Get an initial number of clauses (more accurately).
     if (trail.size() != 0) removeSatisfied();
@@ -692,6 +810,14 @@ bool SimpSolver::eliminate(bool turn_off_elim)
     printf("c No. effective iterative eliminations: %d\n", iter);
 
 cleanup:
+    if (verbosity >= 1 && gates > 0)
+        printf("c Eliminated by gate definitions: %d vars\n", gates);
+
+    // Reruns only try the variables whose occurrences change in the meantime, and need the
+    // abstraction of the original clauses:
+    n_occ.copyTo(elim_occ);
+    grow = grow_init;
+
     touched  .clear(true);
     occurs   .clear(true);
     n_occ    .clear(true);
@@ -700,11 +826,11 @@ cleanup:
 
     use_simplification    = false;
     remove_satisfied      = true;
-    ca.extra_clause_field = false;
+    ca.extra_clause_field = use_inprocess && use_elim;
 
     // Force full cleanup (this is safe and desirable since it only happens once):
     rebuildOrderHeap();
-    garbageCollect();
+    garbageCollectAll();
 
     return res;
 }
@@ -729,8 +855,8 @@ bool SimpSolver::eliminate_()
             !backwardSubsumptionCheck(true)){
             ok = false; goto cleanup; }
 
-        // Empty elim_heap and return immediately on user-interrupt:
-        if (asynch_interrupt){
+        // Empty elim_heap and return immediately on user-interrupt or when out of budget:
+        if (asynch_interrupt || elim_ticks >= elim_budget){
             assert(bwdsub_assigns == trail.size());
             assert(subsumption_queue.size() == 0);
             assert(n_touched == 0);
@@ -741,7 +867,7 @@ bool SimpSolver::eliminate_()
         for (int cnt = 0; !elim_heap.empty(); cnt++){
             Var elim = elim_heap.removeMin();
             
-            if (asynch_interrupt) break;
+            if (asynch_interrupt || elim_ticks >= elim_budget) break;
 
             if (isEliminated(elim) || value(elim) != l_Undef) continue;
 
@@ -779,7 +905,7 @@ bool SimpSolver::eliminate_()
     }
     checkGarbage();
 
-    if (verbosity >= 1 && elimclauses.size() > 0)
+    if (verbosity >= (elim_rounds == 0 ? 1 : 2) && elimclauses.size() > 0)
         printf("c |  Eliminated clauses:     %10.2f Mb                                      |\n", 
                double(elimclauses.size() * sizeof(uint32_t)) / (1024*1024));
 
@@ -787,6 +913,118 @@ bool SimpSolver::eliminate_()
 }
 
 
+// Reruns variable elimination on the original clauses once 'elim_next' conflicts are reached, with
+// the occurrence lists rebuilt for the purpose. Only the variables whose number of occurrences changed
+// since the last run are tried: level 0 units and the clauses that search removed or rewrote may make
+// them cheap enough now. Called at level 0 at the start of each restart.
+bool SimpSolver::inprocess()
+{
+    if (!use_inprocess || !use_elim || conflicts < elim_next) return true;
+    assert(decisionLevel() == 0 && !use_simplification);
+    elim_rounds++;
+    elim_next   = conflicts + (uint64_t)elim_interval * (elim_rounds + 1);
+    elim_budget = elim_ticks + (uint64_t)(elim_effort * (propagations - elim_props));
+    elim_props  = propagations;
+
+    // The occurrence lists are built again for each round instead of being kept up to date during
+    // search, where substitution and transitive reduction delete and rewrite original clauses. The
+    // build is work of the round, and a round whose budget does not even cover it is skipped:
+    uint64_t build = clauses_literals + nVars();
+    if (elim_ticks + build >= elim_budget) return true;
+    elim_ticks += build;
+
+    if (!simplify()) return false;
+
+    use_simplification = true;
+    n_occ  .growTo(2 * nVars(), 0);
+    touched.growTo(nVars(), 0);
+    for (int v = 0; v < nVars(); v++)
+        occurs.init(v);
+    for (int i = 0; i < clauses.size(); i++){
+        Clause& c = ca[clauses[i]];
+        if (c.mark() != 0) continue;
+        c.calcAbstraction();                    // (stale if search rewrote the clause)
+        for (int k = 0; k < c.size(); k++){
+            occurs[var(c[k])].push(clauses[i]);
+            n_occ[toInt(c[k])]++; } }
+
+    // The model is extended by substitution before elimination, so the representatives of
+    // substituted variables must stay. They are frozen for the round:
+    vec<Var> thawed;
+    for (int v = 0; v < nVars(); v++){
+        Var r = var(substLit(mkLit(v)));
+        if (r != v && !frozen[r]){
+            frozen[r] = 1;
+            thawed.push(r); } }
+
+    // The XOR matrices may hold the variables eliminated, so they sit out the round, and are rebuilt
+    // after it if it eliminated any:
+    bool xor_was_stale = xor_stale;
+    xor_stale = true;
+
+    elim_occ.growTo(2 * nVars(), 0);
+    for (int v = 0; v < nVars(); v++){
+        Lit p = mkLit(v);
+        if (isEliminated(v) || frozen[v] || subst[v] != lit_Undef || value(v) != l_Undef) continue;
+        if (n_occ[toInt(p)] == elim_occ[toInt(p)] && n_occ[toInt(~p)] == elim_occ[toInt(~p)]) continue;
+        elim_heap.insert(v);
+        touched[v] = 1;
+        n_touched++; }
+    bwdsub_assigns = trail.size();
+
+    int  eliminated_before = eliminated_vars;
+    bool res               = eliminate_();
+    inpr_eliminated += eliminated_vars - eliminated_before;
+    xor_stale = xor_was_stale || (use_xor && eliminated_vars != eliminated_before);
+    for (int i = 0; i < thawed.size(); i++)
+        frozen[thawed[i]] = 0;
+
+    n_occ.copyTo(elim_occ);
+    touched  .clear(true);
+    occurs   .clear(true);
+    n_occ    .clear(true);
+    elim_heap.clear(true);
+    subsumption_queue.clear(true);
+    use_simplification = false;
+    if (!res) return false;
+
+    if (eliminated_vars != eliminated_before)
+        removeEliminatedLearnts();
+
+    exportNewClauses();
+
+    if (verbosity >= 2)
+        fprintf(stderr, "c Variable elimination round %d: %d variables eliminated, %d clauses left\n",
+                elim_rounds, eliminated_vars - eliminated_before, nClauses());
+    return true;
+}
+
+
+// Deletes the learnt clauses with an eliminated variable. The formula still implies them, but the
+// variable must not come back through them, e.g. as the representative of an equivalence.
+void SimpSolver::removeEliminatedLearnts()
+{
+    for (int t = 0; t < 3; t++){
+        vec<CRef>& cs = t == 0 ? learnts_core : t == 1 ? learnts_tier2 : learnts_local;
+        for (int i = 0; i < cs.size(); i++){
+            const Clause& c = ca[cs[i]];
+            if (c.mark() == 1) continue;            // (listed twice in 'learnts_tier2')
+            for (int k = 0; k < c.size(); k++)
+                if (isEliminated(var(c[k]))){
+                    removeClause(cs[i]);
+                    break; }
+        }
+    }
+    cleanTiers();
+
+    int i, j;
+    for (i = j = 0; i < learnts_local.size(); i++)
+        if (ca[learnts_local[i]].mark() != 1)
+            learnts_local[j++] = learnts_local[i];
+    learnts_local.shrink(i - j);
+}
+
+
 //=================================================================================================
 // Garbage Collection methods:
 
@@ -815,17 +1053,29 @@ void SimpSolver::relocAll(ClauseAllocator& to)
 }
 
 
+// Elimination deletes original clauses all the time, so while it runs, both regions are compacted.
+// Outside of it, the original region is left in place as in 'Solver'.
 void SimpSolver::garbageCollect()
+{
+    if (use_simplification) garbageCollectAll();
+    else                    Solver::garbageCollect();
+}
+
+
+void SimpSolver::garbageCollectAll()
 {
     // Initialize the next region to a size corresponding to the estimated utilization degree. This
     // is not precise but should avoid some unnecessary reallocations for the new region:
-    ClauseAllocator to(ca.size() - ca.wasted()); 
+    ClauseAllocator to(ca.size(true) - ca.wasted(true));
+    to.collectOriginal(ca.size(false) - ca.wasted(false));
 
     to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
     relocAll(to);
     Solver::relocAll(to);
     if (verbosity >= 2)
-        printf("c |  Garbage collection:   %12d bytes => %12d bytes             |\n", 
-               ca.size()*ClauseAllocator::Unit_Size, to.size()*ClauseAllocator::Unit_Size);
+        printf("c |  Garbage collection:   %12" PRIu64 " bytes => %12" PRIu64 " bytes             |\n", 
+               (uint64_t)ca.size()*ClauseAllocator::Unit_Size, (uint64_t)to.size()*ClauseAllocator::Unit_Size);
     to.moveTo(ca);
+    garbage_collections++;
+    original_collections++;
 }
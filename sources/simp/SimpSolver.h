@@ -76,6 +76,7 @@ class SimpSolver : public Solver {
     // Memory managment:
     //
     virtual void garbageCollect();
+    void         garbageCollectAll();            // Compacts the original region too.
 
 
     // Generate a (possibly simplified) DIMACS file:
@@ -100,12 +101,19 @@ class SimpSolver : public Solver {
     bool    use_asymm;         // Shrink clauses by asymmetric branching.
     bool    use_rcheck;        // Check if a clause is already implied. Prett costly, and subsumes subsumptions :)
     bool    use_elim;          // Perform variable elimination.
+    bool    use_inprocess;     // Rerun variable elimination at restarts during search.
+    double  elim_effort;       // Work of a rerun, relative to the propagations of search since the last.
+    int     elim_interval;     // Conflicts before the first rerun; the gap grows by as much after each.
+    bool    use_gates;         // Only resolve the clauses of a gate definition against the rest.
 
     // Statistics:
     //
     int     merges;
     int     asymm_lits;
     int     eliminated_vars;
+    int     elim_rounds;       // Reruns during search,
+    int     inpr_eliminated;   // and the variables they eliminated.
+    int     gates;             // Variables eliminated by their gate definition.
 
  protected:
 
@@ -147,10 +155,16 @@ class SimpSolver : public Solver {
     vec<char>           eliminated;
     int                 bwdsub_assigns;
     int                 n_touched;
+    uint64_t            elim_ticks;        // Work of elimination: literal pairs merged and occurrences scanned.
+    uint64_t            elim_budget;       // Elimination stops once 'elim_ticks' reaches this.
+    uint64_t            elim_next;         // Conflicts at which to rerun elimination.
+    uint64_t            elim_props;        // 'propagations' at the last rerun.
+    vec<int>            elim_occ;          // 'n_occ' at the end of the last elimination.
 
     // Temporaries:
     //
     CRef                bwdsub_tmpunit;
+    vec<char>           gate_mark;         // Per variable: the signs in which 'findGate()' marked it.
 
     // Main internal methods:
     //
@@ -162,8 +176,12 @@ class SimpSolver : public Solver {
     bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, vec<Lit>& out_clause);
     bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, int& size);
     bool          backwardSubsumptionCheck (bool verbose = false);
+    bool          findGate                 (Var v, const vec<CRef>& pos, const vec<CRef>& neg, vec<char>& pos_gate, vec<char>& neg_gate);
+    int           findTernary              (const vec<CRef>& cs, Lit a, Lit b, Lit c);
     bool          eliminateVar             (Var v);
     void          extendModel              ();
+    bool          inprocess                ();
+    void          removeEliminatedLearnts  ();
 
     void          removeClause             (CRef cr);
     bool          strengthenClause         (CRef cr, Lit l);
@@ -0,0 +1,113 @@
+/**************************************************************************************[TransRed.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// Regression test of 'Solver::transitiveReduction()': an original binary clause that is implied
+// only through a learnt binary must survive the reduction, since 'reduceDB()' may delete the learnt
+// one afterwards. The original clauses are
+//
+//     a | b      a | c
+//
+// and 'c -> b' comes either as the learnt clause '~c | b' (which must not justify removing 'a | b')
+// or as an original one (which must). Either way '~a' must still imply 'b' in the end. Nothing is
+// sent to redis, so no server is needed.
+
+#include <stdio.h>
+
+#include "core/Solver.h"
+#include "core/Redis.h"
+
+using namespace Minisat;
+
+class TestSolver : public Solver {
+public:
+    // A learnt clause of the local tier, with the activity that 'reduceDB()' sorts by:
+    CRef addLearnt(const vec<Lit>& ps, float act){
+        CRef cr = ca.alloc(ps, true);
+        ca[cr].mark(LOCAL);
+        ca[cr].set_lbd(ps.size());
+        ca[cr].activity() = act;
+        learnts_local.push(cr);
+        attachClause(cr);
+        return cr; }
+
+    // The learnt binary clauses left (by contents, since 'reduceDB()' may collect garbage):
+    int learntBinaries() const {
+        int n = 0;
+        for (int i = 0; i < learnts_local.size(); i++)
+            n += ca[learnts_local[i]].size() == 2;
+        return n; }
+
+    void reduceLearnts(){ reduceDB(); }
+
+    // TRUE if assigning 'p' propagates 'q':
+    bool implies(Lit p, Lit q){
+        newDecisionLevel();
+        uncheckedEnqueue(p, decisionLevel());
+        bool ok = propagate() == CRef_Undef && value(q) == l_True;
+        cancelUntil(0);
+        return ok; }
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) failures++;
+}
+
+static void run(bool learnt_path)
+{
+    TestSolver S;
+    Redis      redis(S);
+    S.redis     = &redis;
+    S.verbosity = 0;
+
+    Var a = S.newVar(), b = S.newVar(), c = S.newVar();
+    Var d = S.newVar(), e = S.newVar(), f = S.newVar();
+    S.addClause(mkLit(a), mkLit(b));
+    S.addClause(mkLit(a), mkLit(c));
+
+    vec<Lit> ps;
+    ps.push(~mkLit(c)); ps.push(mkLit(b));
+    if (learnt_path){
+        S.addLearnt(ps, 0);
+        // Another learnt clause of higher activity, so that 'reduceDB()' deletes the first:
+        ps.clear(); ps.push(mkLit(d)); ps.push(mkLit(e)); ps.push(mkLit(f));
+        S.addLearnt(ps, 1);
+    }else
+        S.addClause(ps);
+
+    S.transitiveReduction(UINT64_MAX);
+    if (learnt_path){
+        check(S.transred_removed == 0, "learnt path: no original binary removed");
+        redis.learnts.clear();      // (attached clauses are queued for redis)
+        S.reduceLearnts();
+        check(S.learntBinaries() == 0, "learnt path: reduceDB deleted the learnt binary");
+        check(S.implies(~mkLit(a), mkLit(b)), "learnt path: ~a still implies b");
+    }else{
+        check(S.transred_removed == 1, "original path: the implied binary removed");
+        check(S.implies(~mkLit(a), mkLit(b)), "original path: ~a still implies b");
+    }
+}
+
+int main()
+{
+    run(true);
+    run(false);
+    return failures == 0 ? 0 : 1;
+}